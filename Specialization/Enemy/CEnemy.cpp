@@ -1,13 +1,13 @@
 #include <tgSystem.h>
 
 #include "CEnemy.h"
+#include "Octree/COctree.h"
 #include "Octree/SOctreeNode.h"
 #include "Specialization/CLevel.h"
 #include "Navigation/CNavMesh.h"
 
 #include <tgCCollision.h>
 #include <tgCDebugManager.h>
-#include <tgCLine2D.h>
 #include <tgCLine3D.h>
 #include <tgCMesh.h>
 #include <tgCProfiling.h>
@@ -24,6 +24,8 @@ CEnemy::CEnemy( const tgSize Id, const tgCV3D& Position, const tgCSphere& rBound
     , m_MaxDistanceToChangeTargetPoint( 1 )
     , m_TargetPoint( Position )
     , m_Path()
+    , m_NavMeshNode( CNavMesh::INVALID_NODE )
+    , m_NearbyObjects()
     , m_TimeToBeIdle( 1 )
     , m_IdleTimer( 0 )
     , m_IsIdle( false )
@@ -87,7 +89,7 @@ void CEnemy::UpdateTargetPoint( void )
         tgFloat  ClosestDistance = TG_FLOAT_MAX;
         for( tgUInt32 i = 0; i < m_Path.size(); ++i )
         {
-            const tgFloat CurrentDistance = ( *m_Path[i] - m_TransformMatrix.Pos ).Length();
+            const tgFloat CurrentDistance = ( m_Path[i] - m_TransformMatrix.Pos ).Length();
 
             if( CurrentDistance < ClosestDistance )
             {
@@ -96,46 +98,52 @@ void CEnemy::UpdateTargetPoint( void )
             }
         }
 
-        const std::vector<tgCLine3D>& rNavMeshEdges = CLevel::GetInstance().GetNavMesh()->GetEdges();
-        tgCLine2D                     ThisToPathPoint( tgCV2D( m_TransformMatrix.Pos.x, m_TransformMatrix.Pos.z ), 0 );
-        tgUInt32                      FurthestSeeingIndex = 0;
+        const CNavMesh* pNavMesh            = CLevel::GetInstance().GetNavMesh();
+        tgUInt32        FurthestSeeingIndex = 0;
 
-        for( tgSInt32 i = m_Path.size() - 1; i >= 0; --i )
+        // The last node is kept as a hint, enemies rarely move further than a few nodes between updates
+        const tgUInt32 PreviousNode = m_NavMeshNode;
+        tgCV3D         RayStart     = m_TransformMatrix.Pos;
+        m_NavMeshNode               = pNavMesh->GetNode( RayStart, PreviousNode );
+
+        // Collisions can push enemies off the navmesh, they look along the path from the closest node until they are back on it
+        if( m_NavMeshNode == CNavMesh::INVALID_NODE )
         {
-            const tgCV3D* pPathPoint = m_Path[i];
-            ThisToPathPoint.SetEnd( tgCV2D( pPathPoint->x, pPathPoint->z ) );
+            m_NavMeshNode = pNavMesh->GetNearestNode( RayStart, PreviousNode );
+            if( m_NavMeshNode != CNavMesh::INVALID_NODE )
+                RayStart = pNavMesh->GetCenter( m_NavMeshNode );
+        }
 
-            tgBool LinesIntersected = false;
-            for( const tgCLine3D& rNavMeshEdge : rNavMeshEdges )
+        // Without any node nothing can be seen, so the enemy follows the path from the closest point instead of going back to its start
+        if( m_NavMeshNode == CNavMesh::INVALID_NODE )
+        {
+            FurthestSeeingIndex = ClosestIndex;
+        }
+        else
+        {
+            for( tgSInt32 i = m_Path.size() - 1; i >= 0; --i )
             {
-                const tgCV3D&   rStartPoint = rNavMeshEdge.GetStart();
-                const tgCV3D&   rEndPoint   = rNavMeshEdge.GetEnd();
-                const tgCLine2D EdgeLine( tgCV2D( rStartPoint.x, rStartPoint.z ), tgCV2D( rEndPoint.x, rEndPoint.z ) );
+                tgCV3D   HitPoint( 0 );
+                tgUInt32 LastNode = CNavMesh::INVALID_NODE;
 
-                if( EdgeLine.Intersect( ThisToPathPoint ) )
+                if( !pNavMesh->Raycast( m_NavMeshNode, RayStart, m_Path[i], HitPoint, LastNode ) )
                 {
-                    LinesIntersected = true;
+                    FurthestSeeingIndex = i;
                     break;
                 }
             }
-
-            if( !LinesIntersected )
-            {
-                FurthestSeeingIndex = i;
-                break;
-            }
         }
 
         if( FurthestSeeingIndex == m_Path.size() - 1 )
         {
-            m_TargetPoint = *m_Path.back();
+            m_TargetPoint = m_Path.back();
             return;
         }
 
         if( ClosestIndex < FurthestSeeingIndex )
-            m_TargetPoint = *m_Path[FurthestSeeingIndex];
+            m_TargetPoint = m_Path[FurthestSeeingIndex];
         else
-            m_TargetPoint = *m_Path[FurthestSeeingIndex + 1];
+            m_TargetPoint = m_Path[FurthestSeeingIndex + 1];
     }
 }
 
@@ -203,10 +211,21 @@ void CEnemy::HandleCollisionAgainstOthers( const tgFloat DeltaTime )
     if( !m_pCurrentNode )
         return;
 
+    COctree* pOctree = CLevel::GetInstance().GetOctree();
+
+    // The octree leaves are only updated once every enemy has moved, so others can be a frame's move plus a push out of an enemy and out of a wall away from the leaf listing them
+    // CollideWithOther pushes out by up to both collision radii and HandleWallCollision by up to one, the octree's largest radius covers every enemy
+    const tgFloat MaxEnemyPush = pOctree->GetMaxObjectRadius() * 2;
+    const tgFloat MaxWallPush  = pOctree->GetMaxObjectRadius();
+    const tgFloat MaxFrameMove = m_MovementSpeed * DeltaTime + MaxEnemyPush + MaxWallPush;
+
+    // Wide enough for both the turn away and the collision tests
+    pOctree->QuerySphere( tgCSphere( m_BoundingSphere.GetPos(), m_BoundingSphere.GetRadius() * 2 + MaxFrameMove ), m_NearbyObjects );
+
     tgUInt32 NumberOfTurnAways = 0;
-    for( IOctreeObject* pOctreeObject : m_pCurrentNode->Objects )
+    for( IOctreeObject* pOctreeObject : m_NearbyObjects )
     {
-        const CEnemy* pOtherEnemy = reinterpret_cast<CEnemy*>( pOctreeObject );
+        const CEnemy* pOtherEnemy = static_cast<CEnemy*>( pOctreeObject );
         if( pOtherEnemy == this )
             continue;
 
@@ -225,30 +244,6 @@ void CEnemy::HandleCollisionAgainstOthers( const tgFloat DeltaTime )
         m_CollisionSphere.SetPos( m_TransformMatrix.Pos + m_SphereOffset );
     }
 
-    for( const SOctreeNode* pNode : m_CurrentNeighbourNodes )
-    {
-        for( IOctreeObject* pOctreeObject : pNode->Objects )
-        {
-            const CEnemy* pOtherEnemy = reinterpret_cast<CEnemy*>( pOctreeObject );
-            if( pOtherEnemy == this )
-                continue;
-
-            if( !m_IsIdle )
-            {
-                const tgCSphere& rOtherBoundingSphere = pOtherEnemy->m_BoundingSphere;
-
-                if( rOtherBoundingSphere.Intersect( m_BoundingSphere ) )
-                {
-                    TurnAwayFromOther( pOtherEnemy, DeltaTime );
-                    NumberOfTurnAways++;
-                }
-            }
-
-            CollideWithOther( pOtherEnemy );
-            m_CollisionSphere.SetPos( m_TransformMatrix.Pos + m_SphereOffset );
-        }
-    }
-
     if( NumberOfTurnAways >= 7 )
     {
         m_IdleTimer = 0;
@@ -268,9 +263,6 @@ void CEnemy::Render( void )
 
     if( m_pCurrentNode )
         rDebugManager.AddLine3D( tgCLine3D( m_pCurrentNode->Center, m_TransformMatrix.Pos ), tgCColor::Red );
-
-    for( const SOctreeNode* pNode : m_CurrentNeighbourNodes )
-        rDebugManager.AddLine3D( tgCLine3D( pNode->Center, m_TransformMatrix.Pos ), tgCColor::Red );
 }
 
 void CEnemy::TurnAwayFromOther( const CEnemy* pOther, const tgFloat DeltaTime )
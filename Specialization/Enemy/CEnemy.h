@@ -31,7 +31,7 @@ public:
     const tgCSphere& GetCollisionSphere( void ) { return m_CollisionSphere; }
     const tgCSphere& GetCollisionSphere( void ) const { return m_CollisionSphere; }
 
-    void SetPath( const std::vector<const tgCV3D*>& rPath ) { m_Path = rPath; }
+    void SetPath( const std::vector<tgCV3D>& rPath ) { m_Path = rPath; }
     void SetTargetPoint( const tgCV3D& rTargetPoint ) { m_TargetPoint = rTargetPoint; }
 
     tgBool IsDead( void ) { return m_IsDead; }
@@ -46,9 +46,13 @@ protected:
     tgFloat m_MovementSpeed;
     tgFloat m_RotationSpeed;
 
-    tgFloat                    m_MaxDistanceToChangeTargetPoint;
-    tgCV3D                     m_TargetPoint;
-    std::vector<const tgCV3D*> m_Path;
+    tgFloat             m_MaxDistanceToChangeTargetPoint;
+    tgCV3D              m_TargetPoint;
+    std::vector<tgCV3D> m_Path;
+    tgUInt32            m_NavMeshNode;
+
+    // Kept per enemy so enemies can be simulated side by side without sharing a query buffer
+    std::vector<IOctreeObject*> m_NearbyObjects;
 
     tgFloat m_TimeToBeIdle;
     tgFloat m_IdleTimer;
@@ -22,6 +22,7 @@
 CEnemyManager::CEnemyManager()
     : m_Enemies()
     , m_AmountOfEnemies( 100 )
+    , m_MovedEnemies()
     , m_pEnemyModel( nullptr )
     , m_ModelInstance{}
     , m_MaxDistanceToTargetPlayer( 5 )
@@ -46,7 +47,7 @@ CEnemyManager::CEnemyManager()
     {
         tgCMatrix RotationMatrix;
         RotationMatrix.RotateY( tgMathRandom( -180.f, 180.f ), tgCMatrix::COMBINE_REPLACE );
-        tgCV3D RandomStartPos = pNavMesh->GetNode( tgMathRandom( 0, static_cast<tgSInt32>( rLevel.GetNavMesh()->GetNodes().size() ) - 1 ) )->Center;
+        tgCV3D RandomStartPos = pNavMesh->GetCenter( pNavMesh->GetRandomNode() );
         RandomStartPos += RotationMatrix.At * tgMathRandom( 0.f, 5.f );
 
         if( ( RandomStartPos - rPlayerLocation ).Length() < 25 )
@@ -55,13 +56,15 @@ CEnemyManager::CEnemyManager()
         tgCLine3D    Line( tgCV3D( RandomStartPos.x, RandomStartPos.y + 2, RandomStartPos.z ), tgCV3D( RandomStartPos.x, RandomStartPos.y - 5, RandomStartPos.z ) );
         tgCCollision Collision( true );
         Collision.SetType( tgCMesh::TYPE_WORLD );
-        if( pNavMesh->GetNode( RandomStartPos ) && Collision.LineAllMeshesInWorld( Line, *rLevel.GetCollisionWorld() ) )
+        if( pNavMesh->GetNode( RandomStartPos ) != CNavMesh::INVALID_NODE && Collision.LineAllMeshesInWorld( Line, *rLevel.GetCollisionWorld() ) )
         {
             m_Enemies.push_back( new CEnemy( i, Collision.GetLocalIntersection(), ModelBoundingSphere ) );
             rLevel.GetOctree()->Insert( m_Enemies.back() );
         }
     }
 
+    m_MovedEnemies.reserve( m_Enemies.size() );
+
     for( CPathfindingManager::SPathInfo& rPathInfo : rLevel.GetPathfindingManager()->GetPaths() )
         rPathInfo.GoalPosition = rPlayerLocation;
 
@@ -173,15 +176,19 @@ void CEnemyManager::UpdateEnemies( const tgFloat DeltaTime )
     const CLevel&     rLevel          = CLevel::GetInstance();
     const tgCV3D&     rPlayerLocation = rLevel.GetPlayer()->GetPosition();
     COctree*          pOctree         = rLevel.GetOctree();
+    const CNavMesh*   pNavMesh        = rLevel.GetNavMesh();
     const tgCPlane3D* pCameraFrustum  = tgCCameraManager::GetInstance().GetCurrentCamera()->GetFrustum();
     m_ModelInstance.NumMeshes         = 0;
 
+    m_MovedEnemies.clear();
+
     for( CEnemy* pEnemy : m_Enemies )
     {
         if( pEnemy->IsDead() )
             UpdateDeadEnemy( pEnemy );
 
-        if( ( rPlayerLocation - *pEnemy->GetPosition() ).Length() < m_MaxDistanceToTargetPlayer )
+        // Close enemies only go straight for the player when no navmesh boundary is in between, otherwise they would walk into the wall separating them
+        if( ( rPlayerLocation - *pEnemy->GetPosition() ).Length() < m_MaxDistanceToTargetPlayer && !pNavMesh->SegmentHitsBoundary( *pEnemy->GetPosition(), rPlayerLocation ) )
         {
             pEnemy->SetTargetPoint( rPlayerLocation );
             pEnemy->Update( DeltaTime, false );
@@ -189,7 +196,7 @@ void CEnemyManager::UpdateEnemies( const tgFloat DeltaTime )
         else
             pEnemy->Update( DeltaTime, true );
 
-        pOctree->UpdateObject( pEnemy );
+        m_MovedEnemies.push_back( pEnemy );
 
         if( tgFrustumTestSphere( pCameraFrustum, 5, pEnemy->GetBoundingSphere() ) )
         {
@@ -199,6 +206,8 @@ void CEnemyManager::UpdateEnemies( const tgFloat DeltaTime )
         }
     }
 
+    pOctree->UpdateObjects( m_MovedEnemies );
+
     pDeviceContext->Unmap( m_ModelInstance.pInstanceBuffer, 0 );
 }
 
@@ -215,7 +224,7 @@ void CEnemyManager::UpdateDeadEnemy( CEnemy* pEnemy )
 
     do
     {
-        tgCV3D RandomStartPos = pNavMesh->GetNode( tgMathRandom( 0, static_cast<tgSInt32>( rLevel.GetNavMesh()->GetNodes().size() ) - 1 ) )->Center;
+        tgCV3D RandomStartPos = pNavMesh->GetCenter( pNavMesh->GetRandomNode() );
 
         do
         {
@@ -227,9 +236,10 @@ void CEnemyManager::UpdateDeadEnemy( CEnemy* pEnemy )
         const tgCLine3D Line( tgCV3D( RandomStartPos.x, RandomStartPos.y + 2, RandomStartPos.z ), tgCV3D( RandomStartPos.x, RandomStartPos.y - 5, RandomStartPos.z ) );
         tgCCollision    Collision( true );
         Collision.SetType( tgCMesh::TYPE_WORLD );
-        if( pNavMesh->GetNode( RandomStartPos ) && Collision.LineAllMeshesInWorld( Line, *rLevel.GetCollisionWorld() ) )
+        if( pNavMesh->GetNode( RandomStartPos ) != CNavMesh::INVALID_NODE && Collision.LineAllMeshesInWorld( Line, *rLevel.GetCollisionWorld() ) )
         {
             pEnemy->SetPosition( Collision.GetLocalIntersection() );
+            // Respawns jump across the level, so the frame's batch is too late for the enemies simulated after this one
             rLevel.GetOctree()->UpdateObject( pEnemy );
             UpdatedEnemy = true;
         }
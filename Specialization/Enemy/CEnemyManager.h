@@ -8,6 +8,7 @@
 #include <tgMemoryEnable.h>
 
 class CEnemy;
+class IOctreeObject;
 
 class CEnemyManager
 {
@@ -41,6 +42,9 @@ protected:
     std::vector<CEnemy*> m_Enemies;
     const tgUInt32       m_AmountOfEnemies;
 
+    // The enemies are moved in the octree together after the whole frame is simulated
+    std::vector<IOctreeObject*> m_MovedEnemies;
+
     tgCModel*      m_pEnemyModel;
     SModelInstance m_ModelInstance;
 
@@ -0,0 +1,82 @@
+#include <tgSystem.h>
+
+#include "CMappedFile.h"
+
+#include <tgCProfiling.h>
+
+#if defined( TG_WINDOWS )
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // TG_WINDOWS
+
+CMappedFile::CMappedFile( const tgChar* pFileName )
+    : m_pData( nullptr )
+    , m_Size( 0 )
+#if defined( TG_WINDOWS )
+    , m_FileHandle( INVALID_HANDLE_VALUE )
+    , m_MappingHandle( nullptr )
+#endif // TG_WINDOWS
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+#if defined( TG_WINDOWS )
+    m_FileHandle = CreateFileA( pFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if( m_FileHandle == INVALID_HANDLE_VALUE )
+        return;
+
+    LARGE_INTEGER FileSize;
+    if( !GetFileSizeEx( m_FileHandle, &FileSize ) || FileSize.QuadPart == 0 )
+        return;
+
+    m_MappingHandle = CreateFileMappingA( m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if( !m_MappingHandle )
+        return;
+
+    m_pData = static_cast<const tgUInt8*>( MapViewOfFile( m_MappingHandle, FILE_MAP_READ, 0, 0, 0 ) );
+    m_Size  = m_pData ? static_cast<tgSize>( FileSize.QuadPart ) : 0;
+#else
+    const int FileDescriptor = open( pFileName, O_RDONLY );
+    if( FileDescriptor < 0 )
+        return;
+
+    struct stat FileStat;
+    if( fstat( FileDescriptor, &FileStat ) == 0 && FileStat.st_size > 0 )
+    {
+        void* pMapping = mmap( nullptr, static_cast<size_t>( FileStat.st_size ), PROT_READ, MAP_PRIVATE, FileDescriptor, 0 );
+        if( pMapping != MAP_FAILED )
+        {
+            m_pData = static_cast<const tgUInt8*>( pMapping );
+            m_Size  = static_cast<tgSize>( FileStat.st_size );
+        }
+    }
+
+    close( FileDescriptor );
+#endif // TG_WINDOWS
+}
+
+CMappedFile::~CMappedFile( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+#if defined( TG_WINDOWS )
+    if( m_pData )
+        UnmapViewOfFile( m_pData );
+
+    if( m_MappingHandle )
+        CloseHandle( m_MappingHandle );
+
+    if( m_FileHandle != INVALID_HANDLE_VALUE )
+        CloseHandle( m_FileHandle );
+#else
+    if( m_pData )
+        munmap( const_cast<tgUInt8*>( m_pData ), m_Size );
+#endif // TG_WINDOWS
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+class CMappedFile
+{
+public:
+    CMappedFile( const tgChar* pFileName );
+    ~CMappedFile( void );
+
+    tgBool IsOpen( void ) const { return m_pData != nullptr; }
+
+    const tgUInt8* GetData( void ) const { return m_pData; }
+    tgSize         GetSize( void ) const { return m_Size; }
+
+private:
+    CMappedFile( const CMappedFile& ) = delete;
+    CMappedFile& operator=( const CMappedFile& ) = delete;
+
+    const tgUInt8* m_pData;
+    tgSize         m_Size;
+
+#if defined( TG_WINDOWS )
+    void* m_FileHandle;
+    void* m_MappingHandle;
+#endif // TG_WINDOWS
+};
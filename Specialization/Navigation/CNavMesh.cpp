@@ -1,29 +1,103 @@
 #include <tgSystem.h>
 
 #include "CNavMesh.h"
-#include "Managers/CWorldManager.h"
+#include "CNavMeshTriangleSource.h"
+#include "SNavMeshCache.h"
 
 #include <tgCProfiling.h>
 #include <tgCV3D.h>
-#include <tgCDebugManager.h>
 #include <tgCLine3D.h>
+#include <tgCMutex.h>
+#include <tgCThread.h>
+#include <tgCTimer.h>
+#include <tgMath.h>
+
+#include <tgMemoryDisable.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <tgMemoryEnable.h>
+
+// Constants bound to references need a definition of their own before C++17
+constexpr tgUInt32 CNavMesh::INVALID_NODE;
+constexpr tgUInt32 CNavMesh::MAX_POLYGON_VERTICES;
+constexpr tgUInt32 CNavMesh::MAX_RAYCAST_STEPS;
+
+enum ELayoutSection
+{
+    LAYOUT_SECTION_LAYOUT
+    ,LAYOUT_SECTION_TILE_SECTORS
+    ,LAYOUT_SECTION_SECTOR_INDICES
+    ,NUM_LAYOUT_SECTIONS
+};
+
+struct SCacheLayout
+{
+    tgFloat  OriginX;
+    tgFloat  OriginZ;
+    tgFloat  TileSize;
+    tgUInt32 NumTilesX;
+    tgUInt32 NumTilesZ;
+};
+
+struct SCacheTileSectors
+{
+    tgUInt32 FirstSector;
+    tgUInt32 NumSectors;
+};
+
+tgBool BoundsOverlap2D( const tgCAABox3D& rBox1, const tgCAABox3D& rBox2 )
+{
+    return rBox1.GetMin().x <= rBox2.GetMax().x && rBox1.GetMax().x >= rBox2.GetMin().x && rBox1.GetMin().z <= rBox2.GetMax().z && rBox1.GetMax().z >= rBox2.GetMin().z;
+}
+
+// Zero for points above or below the box
+tgFloat GetDistanceSquared2D( const tgCAABox3D& rBox, const tgCV3D& rPoint )
+{
+    const tgFloat X = rPoint.x - tgMathClamp( rBox.GetMin().x, rPoint.x, rBox.GetMax().x );
+    const tgFloat Z = rPoint.z - tgMathClamp( rBox.GetMin().z, rPoint.z, rBox.GetMax().z );
 
-CNavMesh::CNavMesh( const tgCString& rWorldName )
-    : m_Nodes()
-    , m_Edges()
-    , m_pWorld( nullptr )
+    return X * X + Z * Z;
+}
+
+CNavMesh::CNavMesh( const std::vector<tgCV3D>& rVertices, const std::vector<tgUInt32>& rIndices, const tgUInt32 MaxPolygonVertices, const tgFloat TileSize, const tgBool ReorderNodes, const tgBool QuantizeVertices, const tgFloat MaxEdgeError )
+    : m_Tiles()
+    , m_BuildTimes()
+    , m_TileLock()
+    , m_pSource( nullptr )
+    , m_TileSectors()
+    , m_ComponentOffsets()
+    , m_ComponentLabels()
+    , m_NumComponents( 0 )
+    , m_WorldFileName()
+    , m_SourceHash( 0 )
+    , m_MaxPolygonVertices( tgMathClamp( 3U, MaxPolygonVertices, MAX_POLYGON_VERTICES ) )
+    , m_ReorderNodes( ReorderNodes )
+    , m_QuantizeVertices( QuantizeVertices )
+    , m_MaxEdgeError( MaxEdgeError )
+    , m_OriginX( 0 )
+    , m_OriginZ( 0 )
+    , m_TileSize( TileSize )
+    , m_NumTilesX( 0 )
+    , m_NumTilesZ( 0 )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif
 
-    m_pWorld = CWorldManager::GetInstance().GetWorld( rWorldName );
-    if( !m_pWorld )
-        return;
+    for( tgSize i = 0; i < rIndices.size() / 3 * 3; ++i )
+    {
+        if( rIndices[i] >= rVertices.size() )
+            return;
+    }
 
-    CreateNodes();
-    FindNeighbours();
-    FindEdges();
+    m_pSource = new CNavMeshTriangleSource( rVertices, rIndices );
+
+    CreateLayout();
+    LoadAllTiles();
 }
 
 CNavMesh::~CNavMesh( void )
@@ -32,319 +106,838 @@ CNavMesh::~CNavMesh( void )
     tgProfilingScope( __TG_FUNC__ );
 #endif
 
-    m_Nodes.clear();
+    for( CNavMeshTile* pTile : m_Tiles )
+        delete pTile;
+
+    m_Tiles.clear();
+    m_TileSectors.clear();
+
+    delete m_pSource;
+    m_pSource = nullptr;
 }
 
-SNavMeshNode* CNavMesh::GetNode( const tgCV3D& rPoint )
+void CNavMesh::LoadAllTiles( void )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    const tgCLine3D Line( rPoint + tgCV3D( 0, 1, 0 ), rPoint - tgCV3D( 0, 10, 0 ) );
+    m_Tiles.assign( m_TileSectors.size(), nullptr );
 
-    for( SNavMeshNode& rNode : m_Nodes )
-    {
-        if( Line.Intersect( rNode.Triangle ) )
-            return &rNode;
-    }
+    std::vector<tgUInt32> TileIndices( m_Tiles.size() );
+    for( tgUInt32 TileIndex = 0; TileIndex < TileIndices.size(); ++TileIndex )
+        TileIndices[TileIndex] = TileIndex;
 
-    return nullptr;
+    LoadTiles( TileIndices );
 }
 
-void CNavMesh::CreateNodes( void )
+tgBool CNavMesh::LoadTile( const tgUInt32 TileX, const tgUInt32 TileZ )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    for( tgUInt32 SectorIndex = 0; SectorIndex < m_pWorld->GetNumSectors(); SectorIndex++ )
-        LoopSectorMeshes( m_pWorld->GetSector( SectorIndex ) );
+    if( TileX >= m_NumTilesX || TileZ >= m_NumTilesZ )
+        return false;
+
+    const tgUInt32 TileIndex = TileZ * m_NumTilesX + TileX;
+    LoadTiles( std::vector<tgUInt32>( 1, TileIndex ) );
+
+    return m_Tiles[TileIndex] != nullptr;
 }
 
-void CNavMesh::Render()
+void CNavMesh::LoadTiles( const std::vector<tgUInt32>& rTileIndices )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    tgCDebugManager& rDebugManager = tgCDebugManager::GetInstance();
+    std::vector<tgUInt32> TileIndices;
+    TileIndices.reserve( rTileIndices.size() );
+
+    std::lock_guard<std::shared_timed_mutex> TileLock( m_TileLock );
 
-    for( SNavMeshNode& rNode : m_Nodes )
+    for( const tgUInt32 TileIndex : rTileIndices )
     {
-        tgCTriangle3D Triangle = rNode.Triangle;
-        for( int i = 0; i < 3; ++i )
-        {
-            const tgCV3D& Vertex            = rNode.Triangle.GetVertex( i );
-            const tgCV3D  VertexToCenterDir = ( rNode.Center - Vertex ).Normalized();
+        if( TileIndex < m_Tiles.size() && !m_Tiles[TileIndex] && std::find( TileIndices.begin(), TileIndices.end(), TileIndex ) == TileIndices.end() )
+            TileIndices.push_back( TileIndex );
+    }
 
-            Triangle.GetVertex( i ) += VertexToCenterDir * .01f + rNode.Normal * .01f;
-        }
+    CreateTiles( TileIndices, true );
+}
 
-        rDebugManager.AddTriangle3D( Triangle, tgCColor::Purple );
-    }
+void CNavMesh::UnloadTile( const tgUInt32 TileX, const tgUInt32 TileZ )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
 
-    for( tgCLine3D& rEdge : m_Edges )
-    {
-        tgCLine3D Line( rEdge.GetStart() + tgCV3D( 0, .01f, 0 ), rEdge.GetEnd() + tgCV3D( 0, .01f, 0 ) );
+    if( TileX >= m_NumTilesX || TileZ >= m_NumTilesZ )
+        return;
 
-        rDebugManager.AddLine3D( Line, tgCColor::Lime );
-    }
+    std::lock_guard<std::shared_timed_mutex> TileLock( m_TileLock );
+    DestroyTile( TileZ * m_NumTilesX + TileX );
 }
 
-void CNavMesh::LoopSectorMeshes( const tgSWorldSector* pSector )
+tgBool CNavMesh::RebuildTile( const tgUInt32 TileX, const tgUInt32 TileZ )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    for( tgUInt32 MeshIndex = 0; MeshIndex < pSector->NumMeshes; MeshIndex++ )
-        LoopMeshIndices( &pSector->pMeshArray[MeshIndex] );
+    if( !HasSource() || TileX >= m_NumTilesX || TileZ >= m_NumTilesZ )
+        return false;
+
+    const tgUInt32                           TileIndex = TileZ * m_NumTilesX + TileX;
+    std::lock_guard<std::shared_timed_mutex> TileLock( m_TileLock );
+
+    DestroyTile( TileIndex );
+    CreateTiles( std::vector<tgUInt32>( 1, TileIndex ), false );
+
+    return m_Tiles[TileIndex] != nullptr;
 }
 
-void CNavMesh::LoopMeshIndices( const tgCMesh* pMesh )
+void CNavMesh::FindEdges( void )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    for( tgUInt32 IndiceIndex = 0; IndiceIndex < pMesh->GetNumTotalIndices(); IndiceIndex += 3 )
-        CreateNode( pMesh, IndiceIndex );
+    tgCTimer              Timer;
+    std::vector<tgUInt32> DirtyTiles;
+
+    for( const CNavMeshTile* pTile : m_Tiles )
+    {
+        if( pTile && pTile->HasDirtyEdges() )
+            DirtyTiles.push_back( pTile->GetIndex() );
+    }
+
+    // Every tile only reads and writes its own edges, so they are found side by side
+    RunBuildStep( BUILD_STEP_FIND_EDGES, DirtyTiles, false );
+
+    m_BuildTimes.FindEdges = Timer.GetLifeTime();
+}
+
+tgBool CNavMesh::GetTileCoordinates( const tgCV3D& rPoint, tgUInt32& rTileX, tgUInt32& rTileZ ) const
+{
+    const tgFloat TileX = std::floor( ( rPoint.x - m_OriginX ) / m_TileSize );
+    const tgFloat TileZ = std::floor( ( rPoint.z - m_OriginZ ) / m_TileSize );
+
+    if( TileX < 0 || TileZ < 0 || TileX >= m_NumTilesX || TileZ >= m_NumTilesZ )
+        return false;
+
+    rTileX = static_cast<tgUInt32>( TileX );
+    rTileZ = static_cast<tgUInt32>( TileZ );
+    return true;
 }
 
-void CNavMesh::CreateNode( const tgCMesh* pMesh, const tgUInt32 IndiceIndex )
+tgUInt32 CNavMesh::GetNode( const tgCV3D& rPoint ) const
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    const tgCMesh::SVertex* pVertex0 = pMesh->GetVertex( pMesh->GetIndex( IndiceIndex ) );
-    const tgCMesh::SVertex* pVertex1 = pMesh->GetVertex( pMesh->GetIndex( IndiceIndex + 1 ) );
-    const tgCMesh::SVertex* pVertex2 = pMesh->GetVertex( pMesh->GetIndex( IndiceIndex + 2 ) );
+    tgUInt32 TileIndex = INVALID_NODE;
+    tgUInt32 TileX     = 0;
+    tgUInt32 TileZ     = 0;
 
-    SNavMeshNode Node{};
-    Node.Triangle = tgCTriangle3D( pVertex0->Position, pVertex1->Position, pVertex2->Position );
+    if( GetTileCoordinates( rPoint, TileX, TileZ ) )
+    {
+        TileIndex = TileZ * m_NumTilesX + TileX;
 
-    const tgCV3D* VertexArray = Node.Triangle.GetVertexArray();
-    Node.Center.x             = ( VertexArray[0].x + VertexArray[1].x + VertexArray[2].x ) / 3;
-    Node.Center.y             = ( VertexArray[0].y + VertexArray[1].y + VertexArray[2].y ) / 3;
-    Node.Center.z             = ( VertexArray[0].z + VertexArray[1].z + VertexArray[2].z ) / 3;
+        const CNavMeshTile* pTile = m_Tiles[TileIndex];
+        if( pTile )
+        {
+            const tgUInt32 LocalNode = pTile->GetNode( rPoint );
+            if( LocalNode != INVALID_NODE )
+                return GetNodeRef( TileIndex, LocalNode );
+        }
+    }
 
-    Node.Normal = ( pVertex0->Normal + pVertex1->Normal + pVertex2->Normal ) / 3;
+    // Polygons reaching past their own tile square can only be found through the tile that owns them
+    const tgCAABox3D PointBox( rPoint, rPoint );
 
-    Node.Index = m_Nodes.size();
+    for( const CNavMeshTile* pTile : m_Tiles )
+    {
+        if( !pTile || pTile->GetIndex() == TileIndex || !BoundsOverlap2D( pTile->GetBounds(), PointBox ) )
+            continue;
 
-    Node.IsVisited = false;
-    Node.IsClosed  = false;
+        const tgUInt32 LocalNode = pTile->GetNode( rPoint );
+        if( LocalNode != INVALID_NODE )
+            return GetNodeRef( pTile->GetIndex(), LocalNode );
+    }
 
-    m_Nodes.push_back( std::move( Node ) );
+    return INVALID_NODE;
 }
 
-void CNavMesh::FindNeighbours( void )
+tgUInt32 CNavMesh::GetNode( const tgCV3D& rPoint, const tgUInt32 HintNode ) const
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    for( SNavMeshNode& rNode : m_Nodes )
-        FindNeighbours( rNode );
+    if( !IsValidNode( HintNode ) )
+        return GetNode( rPoint );
+
+    const tgCLine3D Line( rPoint + tgCV3D( 0, 1, 0 ), rPoint - tgCV3D( 0, 10, 0 ) );
+    tgUInt32        Node = HintNode;
+
+    // Walk towards the point while the neighbours keep getting closer, most queries land within a few steps
+    for( tgUInt32 Step = 0; Step < 8; ++Step )
+    {
+        if( IntersectsNode( Line, Node ) )
+            return Node;
+
+        const tgCV3D& rCenter         = GetCenter( Node );
+        tgUInt32      ClosestNode     = INVALID_NODE;
+        tgFloat       ClosestDistance = ( rCenter.x - rPoint.x ) * ( rCenter.x - rPoint.x ) + ( rCenter.z - rPoint.z ) * ( rCenter.z - rPoint.z );
+
+        for( const tgUInt32 NeighbourNode : GetNeighbours( Node ).Nodes )
+        {
+            if( NeighbourNode == INVALID_NODE )
+                continue;
+
+            if( IntersectsNode( Line, NeighbourNode ) )
+                return NeighbourNode;
+
+            const tgCV3D& rNeighbourCenter = GetCenter( NeighbourNode );
+            const tgFloat X                = rNeighbourCenter.x - rPoint.x;
+            const tgFloat Z                = rNeighbourCenter.z - rPoint.z;
+            const tgFloat Distance         = ( X * X ) + ( Z * Z );
+
+            if( Distance < ClosestDistance )
+            {
+                ClosestDistance = Distance;
+                ClosestNode     = NeighbourNode;
+            }
+        }
+
+        if( ClosestNode == INVALID_NODE )
+            break;
+
+        Node = ClosestNode;
+    }
+
+    return GetNode( rPoint );
 }
 
-void CNavMesh::FindNeighbours( SNavMeshNode& rNode )
+tgUInt32 CNavMesh::GetNearestNode( const tgCV3D& rPoint, const tgUInt32 HintNode ) const
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    for( tgSize i = rNode.Index + 1; i < m_Nodes.size(); ++i )
+    tgUInt32 NearestNode     = INVALID_NODE;
+    tgFloat  NearestDistance = TG_FLOAT_MAX;
+
+    // A nearby hint bounds the search, so only the tiles around the point are looked through
+    if( IsValidNode( HintNode ) )
     {
-        SNavMeshNode& rNeighbourNode = m_Nodes[i];
+        const tgCV3D& rCenter = GetCenter( HintNode );
+        NearestNode           = HintNode;
+        NearestDistance       = ( rCenter.x - rPoint.x ) * ( rCenter.x - rPoint.x ) + ( rCenter.z - rPoint.z ) * ( rCenter.z - rPoint.z );
+    }
 
-        if( rNode.NeighbourNodes.size() >= 3 )
-            break;
+    for( const CNavMeshTile* pTile : m_Tiles )
+    {
+        if( !pTile || GetDistanceSquared2D( pTile->GetBounds(), rPoint ) >= NearestDistance )
+            continue;
+
+        for( tgUInt32 LocalNode = 0; LocalNode < pTile->GetNumNodes(); ++LocalNode )
+        {
+            const tgCV3D& rCenter  = pTile->GetCenter( LocalNode );
+            const tgFloat Distance = ( rCenter.x - rPoint.x ) * ( rCenter.x - rPoint.x ) + ( rCenter.z - rPoint.z ) * ( rCenter.z - rPoint.z );
+
+            if( Distance < NearestDistance )
+            {
+                NearestDistance = Distance;
+                NearestNode     = GetNodeRef( pTile->GetIndex(), LocalNode );
+            }
+        }
+    }
+
+    return NearestNode;
+}
+
+tgUInt32 CNavMesh::GetRandomNode( void ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    tgUInt32 NumNodes = 0;
+    for( const CNavMeshTile* pTile : m_Tiles )
+        NumNodes += pTile ? pTile->GetNumNodes() : 0;
+
+    if( !NumNodes )
+        return INVALID_NODE;
 
-        if( &rNode == &rNeighbourNode )
+    tgUInt32 Node = static_cast<tgUInt32>( tgMathRandom( 0, static_cast<tgSInt32>( NumNodes ) - 1 ) );
+    for( const CNavMeshTile* pTile : m_Tiles )
+    {
+        if( !pTile )
             continue;
 
-        FindNeighbours( rNode, rNeighbourNode );
+        if( Node < pTile->GetNumNodes() )
+            return GetNodeRef( pTile->GetIndex(), Node );
+
+        Node -= pTile->GetNumNodes();
     }
+
+    return INVALID_NODE;
+}
+
+tgBool CNavMesh::IsValidNode( const tgUInt32 Node ) const
+{
+    if( Node == INVALID_NODE || GetTileIndex( Node ) >= m_Tiles.size() )
+        return false;
+
+    const CNavMeshTile* pTile = m_Tiles[GetTileIndex( Node )];
+    return pTile && GetLocalNode( Node ) < pTile->GetNumNodes();
 }
 
-void CNavMesh::FindNeighbours( SNavMeshNode& rNode, SNavMeshNode& rNeighbourNode )
+tgBool CNavMesh::SegmentHitsBoundary( const tgCV3D& rStart, const tgCV3D& rEnd ) const
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    tgUInt32 SharedVertices = 0;
-    for( tgUInt32 NodeVertexIndex = 0; NodeVertexIndex < 3; NodeVertexIndex++ )
+    tgCAABox3D SegmentBox( rStart, rStart );
+    SegmentBox.AddPoint( rEnd );
+
+    // Edges between two loaded tiles are linked, the boundary left in a tile is the real boundary plus its seams towards unloaded tiles
+    for( CNavMeshTile* pTile : m_Tiles )
     {
-        tgCV3D& rNodeVertex = rNode.Triangle.GetVertex( NodeVertexIndex );
+        if( !pTile || !BoundsOverlap2D( pTile->GetBounds(), SegmentBox ) )
+            continue;
 
-        for( tgUInt32 NeighbourVertexIndex = 0; NeighbourVertexIndex < 3; NeighbourVertexIndex++ )
+        if( pTile->HasDirtyEdges() )
+            pTile->FindEdges( m_MaxEdgeError );
+
+        if( pTile->SegmentHitsBoundary( rStart, rEnd ) )
+            return true;
+    }
+
+    return false;
+}
+
+tgBool CNavMesh::Raycast( const tgUInt32 StartNode, const tgCV3D& rStart, const tgCV3D& rEnd, tgCV3D& rHitPoint, tgUInt32& rLastNode ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    rHitPoint = rStart;
+    rLastNode = StartNode;
+
+    if( !IsValidNode( StartNode ) )
+        return true;
+
+    const tgFloat RayX         = rEnd.x - rStart.x;
+    const tgFloat RayZ         = rEnd.z - rStart.z;
+    tgUInt32      Node         = StartNode;
+    tgUInt32      PreviousNode = INVALID_NODE;
+
+    for( tgUInt32 Step = 0; Step < MAX_RAYCAST_STEPS; ++Step )
+    {
+        tgCV3D         Vertices[MAX_POLYGON_VERTICES];
+        const tgUInt32 NumVertices = GetPolygon( Node, Vertices );
+
+        // The winding decides which side of an edge is inside, polygons keep the winding of their source triangles
+        tgFloat Area = 0;
+        for( tgUInt32 i = 0; i < NumVertices; ++i )
         {
-            tgCV3D& rNeighbourVertex = rNeighbourNode.Triangle.GetVertex( NeighbourVertexIndex );
+            const tgCV3D& rVertex     = Vertices[i];
+            const tgCV3D& rNextVertex = Vertices[( i + 1 ) % NumVertices];
+            Area                     += rVertex.x * rNextVertex.z - rNextVertex.x * rVertex.z;
+        }
 
-            if( rNodeVertex == rNeighbourVertex )
+        const tgFloat Winding   = Area < 0 ? -1.0f : 1.0f;
+        tgFloat       ExitTime  = TG_FLOAT_MAX;
+        tgFloat       ExitError = TG_FLOAT_MAX;
+        tgUInt32      ExitEdge  = INVALID_NODE;
+
+        // The ray leaves a convex polygon through the edge it crosses first on its way out
+        for( tgUInt32 i = 0; i < NumVertices; ++i )
+        {
+            if( PreviousNode != INVALID_NODE && GetNeighbours( Node ).Nodes[i] == PreviousNode )
+                continue;
+
+            const tgCV3D& rVertex     = Vertices[i];
+            const tgCV3D& rNextVertex = Vertices[( i + 1 ) % NumVertices];
+            const tgFloat EdgeX       = rNextVertex.x - rVertex.x;
+            const tgFloat EdgeZ       = rNextVertex.z - rVertex.z;
+            const tgFloat Inside      = ( EdgeX * ( rStart.z - rVertex.z ) - EdgeZ * ( rStart.x - rVertex.x ) ) * Winding;
+            const tgFloat Approach    = ( EdgeX * RayZ - EdgeZ * RayX ) * Winding;
+
+            if( Approach >= 0 )
+                continue;
+
+            // Collinear edges share the crossing time, the one whose span holds the crossing point is the way out
+            const tgFloat Time       = -Inside / Approach;
+            const tgFloat CrossX     = rStart.x + RayX * Time - rVertex.x;
+            const tgFloat CrossZ     = rStart.z + RayZ * Time - rVertex.z;
+            const tgFloat EdgeLength = EdgeX * EdgeX + EdgeZ * EdgeZ;
+            const tgFloat EdgeFactor = EdgeLength > 0 ? ( CrossX * EdgeX + CrossZ * EdgeZ ) / EdgeLength : 0;
+            const tgFloat Error      = std::max( 0.0f, std::max( -EdgeFactor, EdgeFactor - 1.0f ) );
+
+            if( Time < ExitTime - .0001f || ( Time < ExitTime + .0001f && Error < ExitError ) )
             {
-                SharedVertices++;
-                break;
+                ExitTime  = std::min( ExitTime, Time );
+                ExitError = Error;
+                ExitEdge  = i;
             }
         }
 
-        if( SharedVertices == 2 )
+        rLastNode = Node;
+
+        if( ExitEdge == INVALID_NODE || ExitTime >= 1.0f )
         {
-            rNode.NeighbourNodes.push_back( &rNeighbourNode );
-            rNeighbourNode.NeighbourNodes.push_back( &rNode );
-            break;
+            rHitPoint = rEnd;
+            return false;
         }
+
+        const tgUInt32 NeighbourNode = GetNeighbours( Node ).Nodes[ExitEdge];
+        if( NeighbourNode == INVALID_NODE )
+        {
+            rHitPoint = rStart + ( rEnd - rStart ) * tgMathClamp( 0.0f, ExitTime, 1.0f );
+            return true;
+        }
+
+        PreviousNode = Node;
+        Node         = NeighbourNode;
     }
+
+    // A walk this long only happens on degenerate geometry, so the ray is treated as blocked
+    rHitPoint = rStart;
+    return true;
 }
 
-void CNavMesh::FindEdges( void )
+void CNavMesh::CreateLayout( void )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    std::vector<tgCLine3D> Edges;
+    const tgUInt32          NumSectors = m_pSource->GetNumSectors();
+    std::vector<tgCAABox3D> SectorBoxes( NumSectors );
+    std::vector<tgBool>     SectorHasGeometry( NumSectors, false );
+    tgCAABox3D              WorldBox;
+    tgBool                  WorldHasGeometry = false;
 
-    for( SNavMeshNode& rNode : m_Nodes )
+    for( tgUInt32 SectorIndex = 0; SectorIndex < NumSectors; ++SectorIndex )
     {
-        std::vector<const tgCV3D*>  pSharedVertices;
-        std::vector<SNavMeshNode*>& rNeighbourNodes = rNode.NeighbourNodes;
+        SectorHasGeometry[SectorIndex] = m_pSource->GetSectorBounds( SectorIndex, SectorBoxes[SectorIndex] );
+        if( !SectorHasGeometry[SectorIndex] )
+            continue;
 
-        if( rNeighbourNodes.size() == 1 )
-            pSharedVertices = GetSharedVertices( &rNode, rNeighbourNodes[0] );
-        else if( rNeighbourNodes.size() == 2 )
-            pSharedVertices = GetSharedVertices( rNeighbourNodes[0], rNeighbourNodes[1] );
+        if( WorldHasGeometry )
+        {
+            WorldBox.AddPoint( SectorBoxes[SectorIndex].GetMin() );
+            WorldBox.AddPoint( SectorBoxes[SectorIndex].GetMax() );
+        }
         else
+        {
+            WorldBox = SectorBoxes[SectorIndex];
+        }
+
+        WorldHasGeometry = true;
+    }
+
+    m_TileSectors.clear();
+    m_NumTilesX = 0;
+    m_NumTilesZ = 0;
+
+    if( !WorldHasGeometry || m_TileSize <= 0 )
+        return;
+
+    // The far edge of the world has to fall inside the last tile, so there is always one tile more than fits in the extent
+    m_OriginX = WorldBox.GetMin().x;
+    m_OriginZ = WorldBox.GetMin().z;
+
+    while( true )
+    {
+        m_NumTilesX = static_cast<tgUInt32>( ( WorldBox.GetMax().x - m_OriginX ) / m_TileSize ) + 1;
+        m_NumTilesZ = static_cast<tgUInt32>( ( WorldBox.GetMax().z - m_OriginZ ) / m_TileSize ) + 1;
+
+        if( static_cast<tgUInt64>( m_NumTilesX ) * m_NumTilesZ <= CNavMeshTile::MAX_TILES )
+            break;
+
+        m_TileSize *= 2;
+    }
+
+    m_TileSectors.resize( m_NumTilesX * m_NumTilesZ );
+
+    for( tgUInt32 SectorIndex = 0; SectorIndex < NumSectors; ++SectorIndex )
+    {
+        if( !SectorHasGeometry[SectorIndex] )
             continue;
 
-        const tgCV3D*              VertexArray  = rNode.Triangle.GetVertexArray();
-        std::vector<const tgCV3D*> NodeVertices = { &VertexArray[0] ,&VertexArray[1] ,&VertexArray[2] };
-        tgCLine3D                  Edge( 0 );
+        tgUInt32 MinTileX = 0;
+        tgUInt32 MinTileZ = 0;
+        tgUInt32 MaxTileX = 0;
+        tgUInt32 MaxTileZ = 0;
+        GetTileCoordinates( SectorBoxes[SectorIndex].GetMin(), MinTileX, MinTileZ );
+        GetTileCoordinates( SectorBoxes[SectorIndex].GetMax(), MaxTileX, MaxTileZ );
 
-        for( const tgCV3D* pNodeVertex : NodeVertices )
+        for( tgUInt32 TileZ = MinTileZ; TileZ <= MaxTileZ; ++TileZ )
         {
-            tgBool SharedVertex = false;
-            for( const tgCV3D* pSharedVertex : pSharedVertices )
-            {
-                if( *pSharedVertex == *pNodeVertex )
-                {
-                    SharedVertex = true;
-                    break;
-                }
-            }
+            for( tgUInt32 TileX = MinTileX; TileX <= MaxTileX; ++TileX )
+                m_TileSectors[TileZ * m_NumTilesX + TileX].push_back( SectorIndex );
+        }
+    }
+}
 
-            if( !SharedVertex )
-            {
-                if( rNeighbourNodes.size() == 1 )
-                {
-                    Edges.emplace_back( *pNodeVertex, *pSharedVertices[0] );
-                    Edges.emplace_back( *pNodeVertex, *pSharedVertices[1] );
-                    break;
-                }
-
-                if( rNeighbourNodes.size() == 2 )
-                {
-                    if( Edge.GetStart() == 0 )
-                        Edge.SetStart( *pNodeVertex );
-                    else
-                    {
-                        Edge.SetEnd( *pNodeVertex );
-                        Edges.push_back( Edge );
-                        break;
-                    }
-                }
-            }
+tgBool CNavMesh::LoadLayout( const tgChar* pCacheFileName )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const CMappedFile File( pCacheFileName );
+    if( !File.IsOpen() || File.GetSize() < sizeof( SCacheHeader ) + sizeof( SCacheSection ) * NUM_LAYOUT_SECTIONS )
+        return false;
+
+    const SCacheHeader* pHeader = reinterpret_cast<const SCacheHeader*>( File.GetData() );
+    if( pHeader->Magic != CacheLayoutMagic || pHeader->Version != CacheVersion || pHeader->SourceHash != m_SourceHash || pHeader->NumSections != NUM_LAYOUT_SECTIONS )
+        return false;
+
+    const SCacheSection* pSections = reinterpret_cast<const SCacheSection*>( pHeader + 1 );
+    const SCacheLayout*  pLayout   = GetCacheSection<SCacheLayout>( File, pSections[LAYOUT_SECTION_LAYOUT], 1 );
+    if( !pLayout || pLayout->TileSize <= 0 || static_cast<tgUInt64>( pLayout->NumTilesX ) * pLayout->NumTilesZ > CNavMeshTile::MAX_TILES )
+        return false;
+
+    const tgSize             NumTiles       = static_cast<tgSize>( pLayout->NumTilesX ) * pLayout->NumTilesZ;
+    const tgSize             NumIndices     = pSections[LAYOUT_SECTION_SECTOR_INDICES].Count;
+    const SCacheTileSectors* pTileSectors   = GetCacheSection<SCacheTileSectors>( File, pSections[LAYOUT_SECTION_TILE_SECTORS], NumTiles );
+    const tgUInt32*          pSectorIndices = GetCacheSection<tgUInt32>( File, pSections[LAYOUT_SECTION_SECTOR_INDICES], NumIndices );
+
+    if( ( NumTiles && !pTileSectors ) || ( NumIndices && !pSectorIndices ) )
+        return false;
+
+    for( tgSize i = 0; i < NumIndices; ++i )
+    {
+        if( pSectorIndices[i] >= m_pSource->GetNumSectors() )
+            return false;
+    }
+
+    m_TileSectors.assign( NumTiles, std::vector<tgUInt32>() );
+
+    for( tgSize TileIndex = 0; TileIndex < NumTiles; ++TileIndex )
+    {
+        const SCacheTileSectors& rTileSectors = pTileSectors[TileIndex];
+        if( static_cast<tgSize>( rTileSectors.FirstSector ) + rTileSectors.NumSectors > NumIndices )
+            return false;
+
+        m_TileSectors[TileIndex].assign( pSectorIndices + rTileSectors.FirstSector, pSectorIndices + rTileSectors.FirstSector + rTileSectors.NumSectors );
+    }
+
+    m_OriginX   = pLayout->OriginX;
+    m_OriginZ   = pLayout->OriginZ;
+    m_TileSize  = pLayout->TileSize;
+    m_NumTilesX = pLayout->NumTilesX;
+    m_NumTilesZ = pLayout->NumTilesZ;
+    return true;
+}
+
+void CNavMesh::SaveLayout( const tgChar* pCacheFileName ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::vector<SCacheLayout>      Layout( 1 );
+    std::vector<SCacheTileSectors> TileSectors;
+    std::vector<tgUInt32>          SectorIndices;
+
+    Layout[0].OriginX   = m_OriginX;
+    Layout[0].OriginZ   = m_OriginZ;
+    Layout[0].TileSize  = m_TileSize;
+    Layout[0].NumTilesX = m_NumTilesX;
+    Layout[0].NumTilesZ = m_NumTilesZ;
+
+    TileSectors.reserve( m_TileSectors.size() );
+
+    for( const std::vector<tgUInt32>& rSectors : m_TileSectors )
+    {
+        SCacheTileSectors CacheTileSectors;
+        CacheTileSectors.FirstSector = static_cast<tgUInt32>( SectorIndices.size() );
+        CacheTileSectors.NumSectors  = static_cast<tgUInt32>( rSectors.size() );
+
+        TileSectors.push_back( CacheTileSectors );
+        SectorIndices.insert( SectorIndices.end(), rSectors.begin(), rSectors.end() );
+    }
+
+    SCacheHeader Header{};
+    Header.Magic              = CacheLayoutMagic;
+    Header.Version            = CacheVersion;
+    Header.SourceHash         = m_SourceHash;
+    Header.NumSections        = NUM_LAYOUT_SECTIONS;
+    Header.MaxPolygonVertices = m_MaxPolygonVertices;
+
+    SCacheSection Sections[NUM_LAYOUT_SECTIONS]{};
+    tgUInt64      Offset = ( sizeof( Header ) + sizeof( Sections ) + 15 ) & ~static_cast<tgUInt64>( 15 );
+    SetCacheSection( Sections[LAYOUT_SECTION_LAYOUT], Layout, Offset );
+    SetCacheSection( Sections[LAYOUT_SECTION_TILE_SECTORS], TileSectors, Offset );
+    SetCacheSection( Sections[LAYOUT_SECTION_SECTOR_INDICES], SectorIndices, Offset );
+
+    std::vector<tgUInt8> Buffer( static_cast<tgSize>( Offset ), 0 );
+    memcpy( Buffer.data(), &Header, sizeof( Header ) );
+    memcpy( Buffer.data() + sizeof( Header ), Sections, sizeof( Sections ) );
+    CopyCacheSection( Buffer, Sections[LAYOUT_SECTION_LAYOUT], Layout );
+    CopyCacheSection( Buffer, Sections[LAYOUT_SECTION_TILE_SECTORS], TileSectors );
+    CopyCacheSection( Buffer, Sections[LAYOUT_SECTION_SECTOR_INDICES], SectorIndices );
+
+    FILE* pFile = fopen( pCacheFileName, "wb" );
+    if( !pFile )
+        return;
+
+    fwrite( Buffer.data(), 1, Buffer.size(), pFile );
+    fclose( pFile );
+}
+
+void CNavMesh::CreateTiles( const std::vector<tgUInt32>& rTileIndices, const tgBool UseCache )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    tgCTimer Timer;
+    tgDouble StepStart = Timer.GetLifeTime();
+
+    // Tiles only read the world and write their own data, so they are built or loaded side by side
+    RunBuildStep( BUILD_STEP_CREATE, rTileIndices, UseCache );
+
+    m_BuildTimes.Create = Timer.GetLifeTime() - StepStart;
+    StepStart           = Timer.GetLifeTime();
+
+    // Linking writes to both tiles, it stays serial but only visits the edges that are still open
+    for( const tgUInt32 TileIndex : rTileIndices )
+    {
+        CNavMeshTile* pTile = m_Tiles[TileIndex];
+        if( !pTile )
+            continue;
+
+        // Polygons can reach past their tile square, so every loaded tile they touch is linked and not only the direct neighbours
+        for( CNavMeshTile* pOtherTile : m_Tiles )
+        {
+            if( pOtherTile && pOtherTile != pTile && BoundsOverlap2D( pTile->GetBounds(), pOtherTile->GetBounds() ) )
+                pTile->Connect( *pOtherTile );
+        }
+    }
+
+    m_BuildTimes.Connect = Timer.GetLifeTime() - StepStart;
+    StepStart            = Timer.GetLifeTime();
+
+    FindComponents();
+
+    m_BuildTimes.FindComponents = Timer.GetLifeTime() - StepStart;
+}
+
+tgBool CNavMesh::CreateTile( const tgUInt32 TileIndex, const tgBool UseCache )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const tgUInt32 TileX = TileIndex % m_NumTilesX;
+    const tgUInt32 TileZ = TileIndex / m_NumTilesX;
+    CNavMeshTile*  pTile = new CNavMeshTile( TileIndex, m_OriginX + TileX * m_TileSize, m_OriginZ + TileZ * m_TileSize, m_TileSize, m_QuantizeVertices );
+
+    tgChar CacheFileName[256];
+    snprintf( CacheFileName, sizeof( CacheFileName ), "%s.%u_%u.navmesh", m_WorldFileName, TileX, TileZ );
+
+    if( !UseCache || !m_SourceHash || !pTile->LoadCache( CacheFileName, m_SourceHash, m_MaxPolygonVertices ) )
+    {
+        if( !HasSource() )
+        {
+            delete pTile;
+            return false;
         }
+
+        m_pSource->AddSectorTriangles( *pTile, m_TileSectors[TileIndex] );
+        pTile->FinishBuild( m_MaxPolygonVertices, m_ReorderNodes );
+
+        if( m_SourceHash )
+            pTile->SaveCache( CacheFileName, m_SourceHash, m_MaxPolygonVertices );
+    }
+
+    m_Tiles[TileIndex] = pTile;
+    return true;
+}
+
+void CNavMesh::DestroyTile( const tgUInt32 TileIndex )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    if( !m_Tiles[TileIndex] )
+        return;
+
+    delete m_Tiles[TileIndex];
+    m_Tiles[TileIndex] = nullptr;
+
+    // The links into the removed tile become boundary again
+    for( CNavMeshTile* pOtherTile : m_Tiles )
+    {
+        if( pOtherTile )
+            pOtherTile->Disconnect( TileIndex );
     }
 
-    CombineEdges( Edges );
+    FindComponents();
 }
 
-void CNavMesh::CombineEdges( std::vector<tgCLine3D>& rEdges )
+void CNavMesh::FindComponents( void )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    while( !rEdges.empty() )
+    m_ComponentOffsets.assign( m_Tiles.size(), 0 );
+
+    tgUInt32 NumTileComponents = 0;
+    for( tgUInt32 TileIndex = 0; TileIndex < m_Tiles.size(); ++TileIndex )
     {
-        tgBool HasCombinedEdges = false;
-        m_Edges.push_back( rEdges.back() );
-        rEdges.pop_back();
+        m_ComponentOffsets[TileIndex] = NumTileComponents;
+        NumTileComponents            += m_Tiles[TileIndex] ? m_Tiles[TileIndex]->GetNumComponents() : 0;
+    }
+
+    // Union find over the tile components, only links between two tiles can join them
+    std::vector<tgUInt32> Parents( NumTileComponents );
+    for( tgUInt32 i = 0; i < NumTileComponents; ++i )
+        Parents[i] = i;
 
-        do
+    auto FindRoot = [&Parents]( tgUInt32 Component )
+    {
+        while( Parents[Component] != Component )
         {
-            HasCombinedEdges          = false;
-            tgCLine3D& rEdge1         = m_Edges.back();
-            tgCV3D     StartToEndDir1 = ( rEdge1.GetEnd() - rEdge1.GetStart() ).Normalized();
+            Parents[Component] = Parents[Parents[Component]];
+            Component          = Parents[Component];
+        }
 
-            for( tgUInt32 i = 0; i < rEdges.size(); ++i )
+        return Component;
+    };
+
+    for( const CNavMeshTile* pTile : m_Tiles )
+    {
+        if( !pTile )
+            continue;
+
+        for( tgUInt32 LocalNode = 0; LocalNode < pTile->GetNumNodes(); ++LocalNode )
+        {
+            for( const tgUInt32 NeighbourNode : pTile->GetNeighbours( LocalNode ).Nodes )
             {
-                tgCLine3D&    rEdge2 = rEdges[i];
-                tgCV3D        EdgeDir( 0 );
-                const tgCV3D* pEdgePoint1 = nullptr;
-                const tgCV3D* pEdgePoint2 = nullptr;
-
-                if( rEdge1.GetStart() == rEdge2.GetStart() )
-                {
-                    EdgeDir     = ( rEdge2.GetStart() - rEdge2.GetEnd() ).Normalized();
-                    pEdgePoint1 = &rEdge1.GetStart();
-                    pEdgePoint2 = &rEdge2.GetEnd();
-                }
-                else if( rEdge1.GetStart() == rEdge2.GetEnd() )
-                {
-                    EdgeDir     = ( rEdge2.GetEnd() - rEdge2.GetStart() ).Normalized();
-                    pEdgePoint1 = &rEdge1.GetStart();
-                    pEdgePoint2 = &rEdge2.GetStart();
-                }
-                else if( rEdge1.GetEnd() == rEdge2.GetEnd() )
-                {
-                    EdgeDir     = ( rEdge2.GetStart() - rEdge2.GetEnd() ).Normalized();
-                    pEdgePoint1 = &rEdge1.GetEnd();
-                    pEdgePoint2 = &rEdge2.GetStart();
-                }
-                else if( rEdge1.GetEnd() == rEdge2.GetStart() )
-                {
-                    EdgeDir     = ( rEdge2.GetEnd() - rEdge2.GetStart() ).Normalized();
-                    pEdgePoint1 = &rEdge1.GetEnd();
-                    pEdgePoint2 = &rEdge2.GetEnd();
-                }
-
-                if( pEdgePoint1 && pEdgePoint2 && EdgeDir.Between( StartToEndDir1 - .1f, StartToEndDir1 + .1f ) )
-                {
-                    rEdge1.SetEnd( rEdge2.GetEnd() );
-                    rEdges.erase( rEdges.begin() + i );
-                    HasCombinedEdges = true;
-                    break;
-                }
+                if( NeighbourNode == INVALID_NODE || GetTileIndex( NeighbourNode ) == pTile->GetIndex() )
+                    continue;
+
+                const tgUInt32 Root          = FindRoot( m_ComponentOffsets[pTile->GetIndex()] + pTile->GetComponent( LocalNode ) );
+                const tgUInt32 NeighbourRoot = FindRoot( m_ComponentOffsets[GetTileIndex( NeighbourNode )] + GetNodeTile( NeighbourNode ).GetComponent( GetLocalNode( NeighbourNode ) ) );
+
+                Parents[std::max( Root, NeighbourRoot )] = std::min( Root, NeighbourRoot );
             }
-        } while( HasCombinedEdges );
+        }
+    }
+
+    // Roots are numbered in order so the labels are dense
+    m_ComponentLabels.assign( NumTileComponents, INVALID_NODE );
+    m_NumComponents = 0;
+
+    for( tgUInt32 i = 0; i < NumTileComponents; ++i )
+    {
+        const tgUInt32 Root = FindRoot( i );
+        if( m_ComponentLabels[Root] == INVALID_NODE )
+            m_ComponentLabels[Root] = m_NumComponents++;
+
+        m_ComponentLabels[i] = m_ComponentLabels[Root];
     }
 }
 
-std::vector<const tgCV3D*> CNavMesh::GetSharedVertices( const SNavMeshNode* pNode1, const SNavMeshNode* pNode2 )
+void CNavMesh::RunBuildStep( const EBuildStep Step, const std::vector<tgUInt32>& rTileIndices, const tgBool UseCache )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    std::vector<const tgCV3D*> SharedVertices;
-    for( tgUInt32 Node1VertexIndex = 0; Node1VertexIndex < 3; Node1VertexIndex++ )
+    const tgUInt32 NumThreads = std::min( static_cast<tgUInt32>( rTileIndices.size() ), std::max( std::thread::hardware_concurrency(), 1U ) );
+    if( NumThreads <= 1 )
+    {
+        for( const tgUInt32 TileIndex : rTileIndices )
+            RunBuildStep( Step, TileIndex, UseCache );
+
+        return;
+    }
+
+    tgCMutex     Mutex( "NavMeshBuild" );
+    SBuildParams Params;
+    Params.pNavMesh           = this;
+    Params.pTileIndices       = &rTileIndices;
+    Params.Step               = Step;
+    Params.UseCache           = UseCache;
+    Params.pMutex             = &Mutex;
+    Params.NextTile           = 0;
+    Params.NumFinishedThreads = 0;
+
+    std::vector<tgCThread*> Threads;
+    Threads.reserve( NumThreads );
+
+    for( tgUInt32 i = 0; i < NumThreads; ++i )
+        Threads.push_back( new tgCThread( "NavMeshBuild", BuildTilesThread, tgCThread::PRIORITY_NORMAL, 65536U, &Params ) );
+
+    tgBool IsWorking = true;
+    while( IsWorking )
     {
-        const tgCV3D& rNode1Vertex = pNode1->Triangle.GetVertex( Node1VertexIndex );
+        tgSleep( 1 );
+
+        tgCMutexScopeLock ScopeLock( Mutex );
+        IsWorking = Params.NumFinishedThreads < NumThreads;
+    }
 
-        for( tgUInt32 Node2VertexIndex = 0; Node2VertexIndex < 3; Node2VertexIndex++ )
+    for( tgCThread* pThread : Threads )
+        delete pThread;
+}
+
+void CNavMesh::RunBuildStep( const EBuildStep Step, const tgUInt32 TileIndex, const tgBool UseCache )
+{
+    switch( Step )
+    {
+        case BUILD_STEP_CREATE:
         {
-            const tgCV3D& rNode2Vertex = pNode2->Triangle.GetVertex( Node2VertexIndex );
+            CreateTile( TileIndex, UseCache );
+        }
+        break;
 
-            if( rNode1Vertex == rNode2Vertex )
-                SharedVertices.push_back( &rNode1Vertex );
+        case BUILD_STEP_FIND_EDGES:
+        {
+            m_Tiles[TileIndex]->FindEdges( m_MaxEdgeError );
         }
+        break;
     }
+}
+
+void CNavMesh::BuildTilesThread( tgCThread* pThread )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    SBuildParams* pParams = static_cast<SBuildParams*>( pThread->GetUserData() );
 
-    return std::move( SharedVertices );
+    // Every worker keeps taking the next tile, so one slow tile does not hold back a whole batch
+    while( true )
+    {
+        tgUInt32 TileIndex = 0;
+        {
+            tgCMutexScopeLock ScopeLock( *pParams->pMutex );
+            if( pParams->NextTile >= pParams->pTileIndices->size() )
+            {
+                ++pParams->NumFinishedThreads;
+                return;
+            }
+
+            TileIndex = ( *pParams->pTileIndices )[pParams->NextTile++];
+        }
+
+        pParams->pNavMesh->RunBuildStep( pParams->Step, TileIndex, pParams->UseCache );
+    }
 }
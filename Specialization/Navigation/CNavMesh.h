@@ -1,42 +1,154 @@
 #pragma once
 
-#include "SNavMeshNode.h"
+#include "CNavMeshTile.h"
 
 #include <tgMemoryDisable.h>
+#include <shared_mutex>
 #include <vector>
 #include <tgMemoryEnable.h>
 
+class tgCMutex;
+class tgCThread;
+class INavMeshSource;
+
+// A grid of tiles that are loaded, unloaded and rebuilt on their own, nodes are the refs made by CNavMeshTile::GetNodeRef
+// Changing the loaded tiles invalidates every node in them, so tile changes hold the tile lock exclusively and solver searches hold it shared
+// The world constructor and Render are defined in CNavMeshWorld.cpp, everything else builds without the engine
 class CNavMesh
 {
 public:
-    CNavMesh( const tgCString& rWorldName );
+    CNavMesh( const tgCString& rWorldName, const tgChar* pWorldFileName, const tgUInt32 MaxPolygonVertices = 3, const tgFloat TileSize = 64.0f, const tgBool ReorderNodes = false, const tgBool QuantizeVertices = false, const tgFloat MaxEdgeError = .05f );
+    // Builds from a plain triangle list without a loaded world, every three indices are one triangle and tiles are never cached
+    CNavMesh( const std::vector<tgCV3D>& rVertices, const std::vector<tgUInt32>& rIndices, const tgUInt32 MaxPolygonVertices = 3, const tgFloat TileSize = 64.0f, const tgBool ReorderNodes = false, const tgBool QuantizeVertices = false, const tgFloat MaxEdgeError = .05f );
     ~CNavMesh( void );
 
-    SNavMeshNode*              GetNode( const tgUInt32 Index ) { return &m_Nodes[Index]; }
-    SNavMeshNode*              GetNode( const tgCV3D& rPoint );
-    std::vector<SNavMeshNode>& GetNodes( void ) { return m_Nodes; }
+    // Seconds spent in every step of the last tile creation, creating includes the links inside each tile and finding edges is the last FindEdges
+    struct SBuildTimes
+    {
+        tgDouble Create;
+        tgDouble Connect;
+        tgDouble FindEdges;
+        tgDouble FindComponents;
+    };
+
+    static constexpr tgUInt32 INVALID_NODE         = CNavMeshTile::INVALID_NODE;
+    static constexpr tgUInt32 MAX_POLYGON_VERTICES = CNavMeshTile::MAX_POLYGON_VERTICES;
+    static constexpr tgUInt32 MAX_RAYCAST_STEPS    = 4096;
+
+    static tgUInt32 GetNodeRef( const tgUInt32 TileIndex, const tgUInt32 LocalNode ) { return CNavMeshTile::GetNodeRef( TileIndex, LocalNode ); }
+    static tgUInt32 GetTileIndex( const tgUInt32 Node ) { return CNavMeshTile::GetTileIndex( Node ); }
+    static tgUInt32 GetLocalNode( const tgUInt32 Node ) { return CNavMeshTile::GetLocalNode( Node ); }
+
+    tgBool LoadTile( const tgUInt32 TileX, const tgUInt32 TileZ );
+    void   LoadTiles( const std::vector<tgUInt32>& rTileIndices );
+    void   UnloadTile( const tgUInt32 TileX, const tgUInt32 TileZ );
+    tgBool RebuildTile( const tgUInt32 TileX, const tgUInt32 TileZ );
+    tgBool GetTileCoordinates( const tgCV3D& rPoint, tgUInt32& rTileX, tgUInt32& rTileZ ) const;
+
+    // Only SegmentHitsBoundary and debug rendering read the boundary edges, so streaming leaves them dirty and they are found on first use or here
+    void FindEdges( void );
+
+    tgUInt32            GetNumTiles( void ) const { return static_cast<tgUInt32>( m_Tiles.size() ); }
+    tgUInt32            GetNumTilesX( void ) const { return m_NumTilesX; }
+    tgUInt32            GetNumTilesZ( void ) const { return m_NumTilesZ; }
+    const CNavMeshTile* GetTile( const tgUInt32 TileIndex ) const { return m_Tiles[TileIndex]; }
+    const SBuildTimes&  GetBuildTimes( void ) const { return m_BuildTimes; }
+
+    // Searches hold it shared for their whole run, so solvers search side by side and a tile change only waits for the searches already running
+    std::shared_timed_mutex& GetTileLock( void ) const { return m_TileLock; }
+
+    tgUInt32 GetNode( const tgCV3D& rPoint ) const;
+    tgUInt32 GetNode( const tgCV3D& rPoint, const tgUInt32 HintNode ) const;
+    // The node with the closest center in the xz plane, for points off the navmesh where GetNode finds nothing
+    tgUInt32 GetNearestNode( const tgCV3D& rPoint, const tgUInt32 HintNode = INVALID_NODE ) const;
+    tgUInt32 GetRandomNode( void ) const;
+    tgBool   IsValidNode( const tgUInt32 Node ) const;
+
+    const tgCV3D&             GetCenter( const tgUInt32 Node ) const { return GetNodeTile( Node ).GetCenter( GetLocalNode( Node ) ); }
+    const SNavMeshNeighbours& GetNeighbours( const tgUInt32 Node ) const { return GetNodeTile( Node ).GetNeighbours( GetLocalNode( Node ) ); }
+    const SNavMeshPortal*     GetPortal( const tgUInt32 Node, const tgUInt32 NeighbourNode ) const { return GetNodeTile( Node ).GetPortal( GetLocalNode( Node ), NeighbourNode ); }
+    tgUInt32                  GetPolygon( const tgUInt32 Node, tgCV3D* pVertices ) const { return GetNodeTile( Node ).GetPolygon( GetLocalNode( Node ), pVertices ); }
+    const tgCV3D&             GetNormal( const tgUInt32 Node ) const { return GetNodeTile( Node ).GetNormal( GetLocalNode( Node ) ); }
+
+    // Nodes with different components can never reach each other through the loaded tiles
+    tgUInt32 GetComponent( const tgUInt32 Node ) const { return m_ComponentLabels[m_ComponentOffsets[GetTileIndex( Node )] + GetNodeTile( Node ).GetComponent( GetLocalNode( Node ) )]; }
+    tgUInt32 GetNumComponents( void ) const { return m_NumComponents; }
+
+    // True if the segment crosses a simplified boundary edge in the xz plane, needs no start node so it also works for points off the navmesh
+    // Finds the dirty edges of the tiles it passes, so it belongs to the thread that loads and unloads tiles
+    tgBool SegmentHitsBoundary( const tgCV3D& rStart, const tgCV3D& rEnd ) const;
 
-    std::vector<tgCLine3D>& GetEdges( void ) { return m_Edges; }
+    // Walks from StartNode through shared edges towards rEnd in the xz plane, returns true and the crossing point if a boundary edge is hit first
+    // rStart has to lie on StartNode, an invalid StartNode counts as blocked
+    tgBool Raycast( const tgUInt32 StartNode, const tgCV3D& rStart, const tgCV3D& rEnd, tgCV3D& rHitPoint, tgUInt32& rLastNode ) const;
 
     void Render();
 
 private:
-    void LoopSectorMeshes( const tgSWorldSector* pSector );
-    void LoopMeshIndices( const tgCMesh* pMesh );
-    void CreateNode( const tgCMesh* pMesh, const tgUInt32 IndiceIndex );
+    enum EBuildStep
+    {
+        BUILD_STEP_CREATE
+        ,BUILD_STEP_FIND_EDGES
+    };
+
+    struct SBuildParams
+    {
+        CNavMesh*                    pNavMesh;
+        const std::vector<tgUInt32>* pTileIndices;
+        EBuildStep                   Step;
+        tgBool                       UseCache;
+
+        tgCMutex* pMutex;
+        tgUInt32  NextTile;
+        tgUInt32  NumFinishedThreads;
+    };
+
+    static void BuildTilesThread( tgCThread* pThread );
+
+    const CNavMeshTile& GetNodeTile( const tgUInt32 Node ) const { return *m_Tiles[GetTileIndex( Node )]; }
+
+    tgBool HasSource( void ) const { return m_pSource != nullptr; }
+
+    tgBool IntersectsNode( const tgCLine3D& rLine, const tgUInt32 Node ) const { return GetNodeTile( Node ).IntersectsNode( rLine, GetLocalNode( Node ) ); }
+
+    void LoadAllTiles( void );
+
+    void   CreateLayout( void );
+    tgBool LoadLayout( const tgChar* pCacheFileName );
+    void   SaveLayout( const tgChar* pCacheFileName ) const;
+
+    void   CreateTiles( const std::vector<tgUInt32>& rTileIndices, const tgBool UseCache );
+    tgBool CreateTile( const tgUInt32 TileIndex, const tgBool UseCache );
+    void   DestroyTile( const tgUInt32 TileIndex );
+
+    void FindComponents( void );
+
+    void RunBuildStep( const EBuildStep Step, const std::vector<tgUInt32>& rTileIndices, const tgBool UseCache );
+    void RunBuildStep( const EBuildStep Step, const tgUInt32 TileIndex, const tgBool UseCache );
 
-    void FindNeighbours( void );
-    void FindNeighbours( SNavMeshNode& rNode );
-    void FindNeighbours( SNavMeshNode& rNode, SNavMeshNode& rNeighbourNode );
+    std::vector<CNavMeshTile*>      m_Tiles;
+    SBuildTimes                     m_BuildTimes;
+    mutable std::shared_timed_mutex m_TileLock;
 
-    void                       FindEdges( void );
-    void                       CombineEdges( std::vector<tgCLine3D>& rEdges );
-    std::vector<const tgCV3D*> GetSharedVertices( const SNavMeshNode* pNode1, const SNavMeshNode* pNode2 );
+    // The source sectors overlapping every tile
+    INavMeshSource*                    m_pSource;
+    std::vector<std::vector<tgUInt32>> m_TileSectors;
 
-    void CreateNodes( void );
+    // Tile components are numbered from the tile's offset, the labels map them to the component they join across tiles
+    std::vector<tgUInt32> m_ComponentOffsets;
+    std::vector<tgUInt32> m_ComponentLabels;
+    tgUInt32              m_NumComponents;
 
-    std::vector<SNavMeshNode> m_Nodes;
-    std::vector<tgCLine3D>    m_Edges;
+    tgChar   m_WorldFileName[256];
+    tgUInt64 m_SourceHash;
+    tgUInt32 m_MaxPolygonVertices;
+    tgBool   m_ReorderNodes;
+    tgBool   m_QuantizeVertices;
+    tgFloat  m_MaxEdgeError;
 
-    tgCWorld* m_pWorld;
+    tgFloat  m_OriginX;
+    tgFloat  m_OriginZ;
+    tgFloat  m_TileSize;
+    tgUInt32 m_NumTilesX;
+    tgUInt32 m_NumTilesZ;
 };
@@ -0,0 +1,165 @@
+#include <tgSystem.h>
+
+#include "CNavMeshGrid.h"
+
+#include <tgCProfiling.h>
+
+#include <tgMemoryDisable.h>
+#include <cmath>
+#include <tgMemoryEnable.h>
+
+CNavMeshGrid::CNavMeshGrid( void )
+    : m_MinX( 0 )
+    , m_MinZ( 0 )
+    , m_CellSize( 1 )
+    , m_NumCellsX( 0 )
+    , m_NumCellsZ( 0 )
+    , m_CellStarts()
+    , m_Items()
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+}
+
+void CNavMeshGrid::Build( const std::vector<tgCAABox3D>& rItemBoxes )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    Clear();
+
+    if( rItemBoxes.empty() )
+        return;
+
+    m_MinX          = rItemBoxes[0].GetMin().x;
+    m_MinZ          = rItemBoxes[0].GetMin().z;
+    tgFloat MaxX    = rItemBoxes[0].GetMax().x;
+    tgFloat MaxZ    = rItemBoxes[0].GetMax().z;
+    tgFloat ItemSum = 0;
+
+    for( const tgCAABox3D& rBox : rItemBoxes )
+    {
+        m_MinX = rBox.GetMin().x < m_MinX ? rBox.GetMin().x : m_MinX;
+        m_MinZ = rBox.GetMin().z < m_MinZ ? rBox.GetMin().z : m_MinZ;
+        MaxX   = rBox.GetMax().x > MaxX ? rBox.GetMax().x : MaxX;
+        MaxZ   = rBox.GetMax().z > MaxZ ? rBox.GetMax().z : MaxZ;
+
+        ItemSum += ( rBox.GetMax().x - rBox.GetMin().x ) + ( rBox.GetMax().z - rBox.GetMin().z );
+    }
+
+    // Cells roughly the size of an average item keep both the cell lists and the item duplication short
+    const tgFloat AverageItemSize = ItemSum / ( 2 * rItemBoxes.size() );
+    const tgFloat MaxCells        = 4.0f * rItemBoxes.size() + 64;
+
+    m_CellSize = AverageItemSize > .01f ? AverageItemSize : .01f;
+    while( ( ( MaxX - m_MinX ) / m_CellSize + 1 ) * ( ( MaxZ - m_MinZ ) / m_CellSize + 1 ) > MaxCells )
+        m_CellSize *= 2;
+
+    m_NumCellsX = static_cast<tgUInt32>( ( MaxX - m_MinX ) / m_CellSize ) + 1;
+    m_NumCellsZ = static_cast<tgUInt32>( ( MaxZ - m_MinZ ) / m_CellSize ) + 1;
+
+    m_CellStarts.assign( m_NumCellsX * m_NumCellsZ + 1, 0 );
+
+    for( const tgCAABox3D& rBox : rItemBoxes )
+    {
+        for( tgUInt32 CellZ = GetCellZ( rBox.GetMin().z ); CellZ <= GetCellZ( rBox.GetMax().z ); ++CellZ )
+        {
+            for( tgUInt32 CellX = GetCellX( rBox.GetMin().x ); CellX <= GetCellX( rBox.GetMax().x ); ++CellX )
+                m_CellStarts[CellZ * m_NumCellsX + CellX + 1]++;
+        }
+    }
+
+    for( tgSize i = 1; i < m_CellStarts.size(); ++i )
+        m_CellStarts[i] += m_CellStarts[i - 1];
+
+    std::vector<tgUInt32> CellFill( m_CellStarts.begin(), m_CellStarts.end() - 1 );
+    m_Items.resize( m_CellStarts.back() );
+
+    for( tgUInt32 ItemIndex = 0; ItemIndex < rItemBoxes.size(); ++ItemIndex )
+    {
+        const tgCAABox3D& rBox = rItemBoxes[ItemIndex];
+
+        for( tgUInt32 CellZ = GetCellZ( rBox.GetMin().z ); CellZ <= GetCellZ( rBox.GetMax().z ); ++CellZ )
+        {
+            for( tgUInt32 CellX = GetCellX( rBox.GetMin().x ); CellX <= GetCellX( rBox.GetMax().x ); ++CellX )
+                m_Items[CellFill[CellZ * m_NumCellsX + CellX]++] = ItemIndex;
+        }
+    }
+}
+
+void CNavMeshGrid::Clear( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    m_NumCellsX = 0;
+    m_NumCellsZ = 0;
+    m_CellStarts.clear();
+    m_Items.clear();
+}
+
+tgBool CNavMeshGrid::GetCell( const tgFloat X, const tgFloat Z, tgUInt32& rCellIndex ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const tgFloat CellX = std::floor( ( X - m_MinX ) / m_CellSize );
+    const tgFloat CellZ = std::floor( ( Z - m_MinZ ) / m_CellSize );
+
+    if( CellX < 0 || CellZ < 0 || CellX >= m_NumCellsX || CellZ >= m_NumCellsZ )
+        return false;
+
+    rCellIndex = static_cast<tgUInt32>( CellZ ) * m_NumCellsX + static_cast<tgUInt32>( CellX );
+    return true;
+}
+
+const tgUInt32* CNavMeshGrid::GetCellItems( const tgUInt32 CellIndex, tgUInt32& rNumItems ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    rNumItems = m_CellStarts[CellIndex + 1] - m_CellStarts[CellIndex];
+    return m_Items.data() + m_CellStarts[CellIndex];
+}
+
+tgBool CNavMeshGrid::ClipSegment( const tgFloat Direction, const tgFloat Distance, tgFloat& rMinT, tgFloat& rMaxT )
+{
+    if( Direction == 0 )
+        return Distance >= 0;
+
+    const tgFloat T = Distance / Direction;
+
+    if( Direction < 0 )
+    {
+        if( T > rMaxT )
+            return false;
+
+        rMinT = T > rMinT ? T : rMinT;
+    }
+    else
+    {
+        if( T < rMinT )
+            return false;
+
+        rMaxT = T < rMaxT ? T : rMaxT;
+    }
+
+    return true;
+}
+
+tgUInt32 CNavMeshGrid::GetCellX( const tgFloat X ) const
+{
+    const tgFloat CellX = std::floor( ( X - m_MinX ) / m_CellSize );
+    return CellX <= 0 ? 0 : CellX >= m_NumCellsX ? m_NumCellsX - 1 : static_cast<tgUInt32>( CellX );
+}
+
+tgUInt32 CNavMeshGrid::GetCellZ( const tgFloat Z ) const
+{
+    const tgFloat CellZ = std::floor( ( Z - m_MinZ ) / m_CellSize );
+    return CellZ <= 0 ? 0 : CellZ >= m_NumCellsZ ? m_NumCellsZ - 1 : static_cast<tgUInt32>( CellZ );
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <tgCAABox3D.h>
+
+#include <tgMemoryDisable.h>
+#include <vector>
+#include <tgMemoryEnable.h>
+
+class CNavMeshGrid
+{
+public:
+    CNavMeshGrid( void );
+
+    void Build( const std::vector<tgCAABox3D>& rItemBoxes );
+    void Clear( void );
+
+    tgBool GetCell( const tgFloat X, const tgFloat Z, tgUInt32& rCellIndex ) const;
+
+    const tgUInt32* GetCellItems( const tgUInt32 CellIndex, tgUInt32& rNumItems ) const;
+
+    // Calls rVisitor( CellIndex ) for every cell the XZ segment passes through, in order, until it returns true
+    template<typename TVisitor>
+    tgBool VisitSegmentCells( const tgFloat StartX, const tgFloat StartZ, const tgFloat EndX, const tgFloat EndZ, TVisitor& rVisitor ) const;
+
+private:
+    static tgBool ClipSegment( const tgFloat Direction, const tgFloat Distance, tgFloat& rMinT, tgFloat& rMaxT );
+
+    tgUInt32 GetCellX( const tgFloat X ) const;
+    tgUInt32 GetCellZ( const tgFloat Z ) const;
+
+    tgFloat  m_MinX;
+    tgFloat  m_MinZ;
+    tgFloat  m_CellSize;
+    tgUInt32 m_NumCellsX;
+    tgUInt32 m_NumCellsZ;
+
+    std::vector<tgUInt32> m_CellStarts;
+    std::vector<tgUInt32> m_Items;
+};
+
+template<typename TVisitor>
+tgBool CNavMeshGrid::VisitSegmentCells( const tgFloat StartX, const tgFloat StartZ, const tgFloat EndX, const tgFloat EndZ, TVisitor& rVisitor ) const
+{
+    if( m_CellStarts.empty() )
+        return false;
+
+    const tgFloat DirectionX = EndX - StartX;
+    const tgFloat DirectionZ = EndZ - StartZ;
+    const tgFloat MaxX       = m_MinX + m_NumCellsX * m_CellSize;
+    const tgFloat MaxZ       = m_MinZ + m_NumCellsZ * m_CellSize;
+    tgFloat       MinT       = 0;
+    tgFloat       MaxT       = 1;
+
+    if( !ClipSegment( -DirectionX, StartX - m_MinX, MinT, MaxT ) || !ClipSegment( DirectionX, MaxX - StartX, MinT, MaxT ) ||
+        !ClipSegment( -DirectionZ, StartZ - m_MinZ, MinT, MaxT ) || !ClipSegment( DirectionZ, MaxZ - StartZ, MinT, MaxT ) )
+        return false;
+
+    const tgFloat X = StartX + DirectionX * MinT;
+    const tgFloat Z = StartZ + DirectionZ * MinT;
+
+    tgSInt32       CellX    = static_cast<tgSInt32>( GetCellX( X ) );
+    tgSInt32       CellZ    = static_cast<tgSInt32>( GetCellZ( Z ) );
+    const tgSInt32 EndCellX = static_cast<tgSInt32>( GetCellX( StartX + DirectionX * MaxT ) );
+    const tgSInt32 EndCellZ = static_cast<tgSInt32>( GetCellZ( StartZ + DirectionZ * MaxT ) );
+    const tgSInt32 StepX    = DirectionX > 0 ? 1 : -1;
+    const tgSInt32 StepZ    = DirectionZ > 0 ? 1 : -1;
+
+    tgFloat       NextT[2]  = { TG_FLOAT_MAX, TG_FLOAT_MAX };
+    const tgFloat DeltaT[2] = { DirectionX != 0 ? m_CellSize / tgMathAbs( DirectionX ) : TG_FLOAT_MAX, DirectionZ != 0 ? m_CellSize / tgMathAbs( DirectionZ ) : TG_FLOAT_MAX };
+
+    if( DirectionX != 0 )
+        NextT[0] = MinT + ( m_MinX + ( CellX + ( StepX > 0 ? 1 : 0 ) ) * m_CellSize - X ) / DirectionX;
+
+    if( DirectionZ != 0 )
+        NextT[1] = MinT + ( m_MinZ + ( CellZ + ( StepZ > 0 ? 1 : 0 ) ) * m_CellSize - Z ) / DirectionZ;
+
+    for( tgUInt32 Step = 0; Step <= m_NumCellsX + m_NumCellsZ; ++Step )
+    {
+        if( rVisitor( static_cast<tgUInt32>( CellZ ) * m_NumCellsX + static_cast<tgUInt32>( CellX ) ) )
+            return true;
+
+        if( CellX == EndCellX && CellZ == EndCellZ )
+            break;
+
+        if( NextT[0] < NextT[1] )
+        {
+            CellX    += StepX;
+            NextT[0] += DeltaT[0];
+        }
+        else
+        {
+            CellZ    += StepZ;
+            NextT[1] += DeltaT[1];
+        }
+
+        if( CellX < 0 || CellZ < 0 || CellX >= static_cast<tgSInt32>( m_NumCellsX ) || CellZ >= static_cast<tgSInt32>( m_NumCellsZ ) )
+            break;
+    }
+
+    return false;
+}
@@ -0,0 +1,1308 @@
+#include <tgSystem.h>
+
+#include "CNavMeshTile.h"
+#include "SNavMeshCache.h"
+
+#include <tgCProfiling.h>
+#include <tgCV3D.h>
+#include <tgCLine2D.h>
+#include <tgCLine3D.h>
+#include <tgCTriangle3D.h>
+#include <tgMath.h>
+
+#include <tgMemoryDisable.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <tgMemoryEnable.h>
+
+// Constants bound to references need a definition of their own before C++17
+constexpr tgUInt32 SNavMeshNeighbours::MAX_NEIGHBOURS;
+constexpr tgUInt32 CNavMeshTile::INVALID_NODE;
+constexpr tgUInt32 CNavMeshTile::MAX_POLYGON_VERTICES;
+constexpr tgUInt32 CNavMeshTile::LOCAL_NODE_BITS;
+constexpr tgUInt32 CNavMeshTile::MAX_TILE_NODES;
+constexpr tgUInt32 CNavMeshTile::MAX_TILES;
+constexpr tgUInt32 CNavMeshTile::MAX_QUANTIZED_STEPS;
+constexpr tgFloat  CNavMeshTile::MIN_EDGE_ERROR;
+
+struct SVertexKey
+{
+    tgSInt32 X;
+    tgSInt32 Y;
+    tgSInt32 Z;
+
+    tgBool operator==( const SVertexKey& rOther ) const { return X == rOther.X && Y == rOther.Y && Z == rOther.Z; }
+    tgBool operator<( const SVertexKey& rOther ) const { return X != rOther.X ? X < rOther.X : Y != rOther.Y ? Y < rOther.Y : Z < rOther.Z; }
+};
+
+struct SVertexKeyHash
+{
+    tgSize operator()( const SVertexKey& rKey ) const
+    {
+        const tgSInt32 Values[3] = { rKey.X, rKey.Y, rKey.Z };
+
+        tgSize Hash = 14695981039346656037ULL;
+        for( const tgSInt32 Value : Values )
+            Hash = ( Hash ^ static_cast<tgUInt32>( Value ) ) * 1099511628211ULL;
+
+        return Hash;
+    }
+};
+
+struct SEdgeKey
+{
+    SVertexKey Start;
+    SVertexKey End;
+
+    tgBool operator==( const SEdgeKey& rOther ) const { return Start == rOther.Start && End == rOther.End; }
+};
+
+struct SEdgeKeyHash
+{
+    tgSize operator()( const SEdgeKey& rKey ) const
+    {
+        const tgSInt32 Values[6] = { rKey.Start.X, rKey.Start.Y, rKey.Start.Z, rKey.End.X, rKey.End.Y, rKey.End.Z };
+
+        tgSize Hash = 14695981039346656037ULL;
+        for( const tgSInt32 Value : Values )
+            Hash = ( Hash ^ static_cast<tgUInt32>( Value ) ) * 1099511628211ULL;
+
+        return Hash;
+    }
+};
+
+// Vertices in the same cell of a grid with Scale cells per unit are treated as shared
+SVertexKey GetVertexKey( const tgCV3D& rVertex, const tgFloat Scale )
+{
+    SVertexKey Key;
+    Key.X = static_cast<tgSInt32>( std::floor( rVertex.x * Scale + .5f ) );
+    Key.Y = static_cast<tgSInt32>( std::floor( rVertex.y * Scale + .5f ) );
+    Key.Z = static_cast<tgSInt32>( std::floor( rVertex.z * Scale + .5f ) );
+
+    return Key;
+}
+
+// Undirected edges between pool vertices, the lower index in the high bits
+tgUInt64 GetEdgeKey( const tgUInt32 Start, const tgUInt32 End )
+{
+    return Start < End ? ( static_cast<tgUInt64>( Start ) << 32 ) | End : ( static_cast<tgUInt64>( End ) << 32 ) | Start;
+}
+
+enum ECacheSection
+{
+    CACHE_SECTION_VERTICES
+    ,CACHE_SECTION_QUANTIZED_VERTICES
+    ,CACHE_SECTION_QUANTIZATION_ORIGIN
+    ,CACHE_SECTION_INDICES
+    ,CACHE_SECTION_POLYGONS
+    ,CACHE_SECTION_CENTERS
+    ,CACHE_SECTION_NORMALS
+    ,CACHE_SECTION_NEIGHBOURS
+    ,CACHE_SECTION_PORTALS
+    ,CACHE_SECTION_COMPONENTS
+    ,NUM_CACHE_SECTIONS
+};
+
+// Polygons are kept as indices into the vertex pool while merging
+typedef std::vector<tgUInt32> TMergePolygon;
+
+// Joins two polygons over the edge Edge of rPolygon1, which rPolygon2 holds in the opposite direction
+tgBool JoinPolygons( const TMergePolygon& rPolygon1, const tgUInt32 Edge, const TMergePolygon& rPolygon2, TMergePolygon& rMerged )
+{
+    const tgSize   NumVertices1 = rPolygon1.size();
+    const tgSize   NumVertices2 = rPolygon2.size();
+    const tgUInt32 EdgeStart    = rPolygon1[Edge];
+    const tgUInt32 EdgeEnd      = rPolygon1[( Edge + 1 ) % NumVertices1];
+
+    for( tgSize i = 0; i < NumVertices2; ++i )
+    {
+        if( rPolygon2[i] != EdgeEnd || rPolygon2[( i + 1 ) % NumVertices2] != EdgeStart )
+            continue;
+
+        rMerged.clear();
+        for( tgSize j = 1; j <= NumVertices1; ++j )
+            rMerged.push_back( rPolygon1[( Edge + j ) % NumVertices1] );
+
+        for( tgSize j = 2; j < NumVertices2; ++j )
+            rMerged.push_back( rPolygon2[( i + j ) % NumVertices2] );
+
+        return true;
+    }
+
+    return false;
+}
+
+// Collinear corners are allowed, they are left behind where a neighbour still splits the edge
+tgBool IsConvexPolygon( const TMergePolygon& rPolygon, const std::vector<tgCV3D>& rVertices, const tgCV3D& rNormal )
+{
+    const tgSize NumVertices = rPolygon.size();
+
+    for( tgSize i = 0; i < NumVertices; ++i )
+    {
+        const tgCV3D& rPrevious = rVertices[rPolygon[( i + NumVertices - 1 ) % NumVertices]];
+        const tgCV3D& rCurrent  = rVertices[rPolygon[i]];
+        const tgCV3D& rNext     = rVertices[rPolygon[( i + 1 ) % NumVertices]];
+
+        tgCV3D Turn( 0 );
+        Turn.CrossProduct( rCurrent - rPrevious, rNext - rCurrent );
+
+        if( Turn.DotProduct( rNormal ) < -.0001f )
+            return false;
+    }
+
+    return true;
+}
+
+// Distance along a 16 bit Hilbert curve, points close on the curve are close in the plane
+tgUInt32 GetHilbertIndex( tgUInt32 X, tgUInt32 Z )
+{
+    tgUInt32 Index = 0;
+
+    for( tgUInt32 Size = 1U << 15; Size > 0; Size >>= 1 )
+    {
+        const tgUInt32 RegionX = ( X & Size ) ? 1 : 0;
+        const tgUInt32 RegionZ = ( Z & Size ) ? 1 : 0;
+        Index                 += Size * Size * ( ( 3 * RegionX ) ^ RegionZ );
+
+        // Rotate the quadrant so the curve continues where the last one ended
+        if( RegionZ == 0 )
+        {
+            if( RegionX == 1 )
+            {
+                X = 0xFFFF - X;
+                Z = 0xFFFF - Z;
+            }
+
+            std::swap( X, Z );
+        }
+    }
+
+    return Index;
+}
+
+CNavMeshTile::CNavMeshTile( const tgUInt32 TileIndex, const tgFloat MinX, const tgFloat MinZ, const tgFloat Size, const tgBool QuantizeVertices )
+    : m_Centers()
+    , m_Neighbours()
+    , m_Portals()
+    , m_Polygons()
+    , m_Indices()
+    , m_Normals()
+    , m_Vertices()
+    , m_QuantizedVertices()
+    , m_QuantizationOrigin()
+    , m_VertexScale( QuantizeVertices ? MAX_QUANTIZED_STEPS / ( Size * 2 ) : 1000.0f )
+    , m_QuantizeVertices( QuantizeVertices )
+    , m_Components()
+    , m_NumComponents( 0 )
+    , m_Contours()
+    , m_Edges()
+    , m_HasDirtyEdges( true )
+    , m_BoundaryLines()
+    , m_NodeGrid()
+    , m_EdgeGrid()
+    , m_Bounds()
+    , m_TileIndex( TileIndex )
+    , m_MinX( MinX )
+    , m_MinZ( MinZ )
+    , m_Size( Size )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif
+}
+
+CNavMeshTile::~CNavMeshTile( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif
+
+    m_Centers.clear();
+    m_Neighbours.clear();
+    m_Portals.clear();
+    m_Polygons.clear();
+    m_Indices.clear();
+    m_Normals.clear();
+    m_Vertices.clear();
+    m_QuantizedVertices.clear();
+}
+
+tgUInt32 CNavMeshTile::GetNode( const tgCV3D& rPoint ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    tgUInt32 CellIndex = 0;
+    if( !m_NodeGrid.GetCell( rPoint.x, rPoint.z, CellIndex ) )
+        return INVALID_NODE;
+
+    const tgCLine3D Line( rPoint + tgCV3D( 0, 1, 0 ), rPoint - tgCV3D( 0, 10, 0 ) );
+    tgUInt32        NumNodes     = 0;
+    const tgUInt32* pNodeIndices = m_NodeGrid.GetCellItems( CellIndex, NumNodes );
+
+    for( tgUInt32 i = 0; i < NumNodes; ++i )
+    {
+        if( IntersectsNode( Line, pNodeIndices[i] ) )
+            return pNodeIndices[i];
+    }
+
+    return INVALID_NODE;
+}
+
+tgUInt32 CNavMeshTile::GetPolygon( const tgUInt32 Node, tgCV3D* pVertices ) const
+{
+    const SNavMeshPolygon& rPolygon = m_Polygons[Node];
+
+    for( tgUInt32 i = 0; i < rPolygon.NumVertices; ++i )
+        pVertices[i] = GetVertex( m_Indices[rPolygon.FirstIndex + i] );
+
+    return rPolygon.NumVertices;
+}
+
+tgCV3D CNavMeshTile::GetVertex( const tgUInt32 VertexIndex ) const
+{
+    if( m_QuantizedVertices.empty() )
+        return m_Vertices[VertexIndex];
+
+    // Decoding from the integer cell makes a vertex shared by two tiles come out bit identical in both
+    const SNavMeshQuantizedVertex& rVertex = m_QuantizedVertices[VertexIndex];
+    return tgCV3D( static_cast<tgFloat>( m_QuantizationOrigin[0] + rVertex.X ) / m_VertexScale,
+                   static_cast<tgFloat>( m_QuantizationOrigin[1] + rVertex.Y ) / m_VertexScale,
+                   static_cast<tgFloat>( m_QuantizationOrigin[2] + rVertex.Z ) / m_VertexScale );
+}
+
+tgBool CNavMeshTile::IntersectsNode( const tgCLine3D& rLine, const tgUInt32 Node ) const
+{
+    tgCV3D         Vertices[MAX_POLYGON_VERTICES];
+    const tgUInt32 NumVertices = GetPolygon( Node, Vertices );
+
+    for( tgUInt32 i = 2; i < NumVertices; ++i )
+    {
+        if( rLine.Intersect( tgCTriangle3D( Vertices[0], Vertices[i - 1], Vertices[i] ) ) )
+            return true;
+    }
+
+    return false;
+}
+
+tgBool CNavMeshTile::LoadCache( const tgChar* pCacheFileName, const tgUInt64 SourceHash, const tgUInt32 MaxPolygonVertices )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const CMappedFile File( pCacheFileName );
+    if( !File.IsOpen() || File.GetSize() < sizeof( SCacheHeader ) + sizeof( SCacheSection ) * NUM_CACHE_SECTIONS )
+        return false;
+
+    const SCacheHeader* pHeader = reinterpret_cast<const SCacheHeader*>( File.GetData() );
+    if( pHeader->Magic != CacheTileMagic || pHeader->Version != CacheVersion || pHeader->SourceHash != SourceHash || pHeader->NumSections != NUM_CACHE_SECTIONS || pHeader->MaxPolygonVertices != MaxPolygonVertices )
+        return false;
+
+    const SCacheSection* pSections            = reinterpret_cast<const SCacheSection*>( pHeader + 1 );
+    const tgSize         NumNodes             = pSections[CACHE_SECTION_CENTERS].Count;
+    const tgSize         NumIndices           = pSections[CACHE_SECTION_INDICES].Count;
+    const tgSize         NumFloatVertices     = pSections[CACHE_SECTION_VERTICES].Count;
+    const tgSize         NumQuantizedVertices = pSections[CACHE_SECTION_QUANTIZED_VERTICES].Count;
+    const tgSize         NumVertices          = NumFloatVertices + NumQuantizedVertices;
+
+    const tgCV3D*                  pVertices           = GetCacheSection<tgCV3D>( File, pSections[CACHE_SECTION_VERTICES], NumFloatVertices );
+    const SNavMeshQuantizedVertex* pQuantizedVertices  = GetCacheSection<SNavMeshQuantizedVertex>( File, pSections[CACHE_SECTION_QUANTIZED_VERTICES], NumQuantizedVertices );
+    const tgSInt32*                pQuantizationOrigin = GetCacheSection<tgSInt32>( File, pSections[CACHE_SECTION_QUANTIZATION_ORIGIN], 3 );
+    const tgUInt32*                pIndices            = GetCacheSection<tgUInt32>( File, pSections[CACHE_SECTION_INDICES], NumIndices );
+    const SNavMeshPolygon*         pPolygons           = GetCacheSection<SNavMeshPolygon>( File, pSections[CACHE_SECTION_POLYGONS], NumNodes );
+    const tgCV3D*                  pCenters            = GetCacheSection<tgCV3D>( File, pSections[CACHE_SECTION_CENTERS], NumNodes );
+    const tgCV3D*                  pNormals            = GetCacheSection<tgCV3D>( File, pSections[CACHE_SECTION_NORMALS], NumNodes );
+    const SNavMeshNeighbours*      pNeighbours         = GetCacheSection<SNavMeshNeighbours>( File, pSections[CACHE_SECTION_NEIGHBOURS], NumNodes );
+    const SNavMeshPortal*          pPortals            = GetCacheSection<SNavMeshPortal>( File, pSections[CACHE_SECTION_PORTALS], NumNodes * MAX_POLYGON_VERTICES );
+    const tgUInt32*                pComponents         = GetCacheSection<tgUInt32>( File, pSections[CACHE_SECTION_COMPONENTS], NumNodes );
+
+    // An empty tile is valid, it still has to be cached so streaming it in does not touch the world
+    if( NumNodes > MAX_TILE_NODES || !pQuantizationOrigin || ( NumFloatVertices && NumQuantizedVertices ) || ( NumQuantizedVertices && !m_QuantizeVertices ) )
+        return false;
+
+    if( NumNodes && ( ( !pVertices && !pQuantizedVertices ) || !pIndices || !pPolygons || !pCenters || !pNormals || !pNeighbours || !pPortals || !pComponents ) )
+        return false;
+
+    for( tgSize Index = 0; Index < NumIndices; ++Index )
+    {
+        if( pIndices[Index] >= NumVertices )
+            return false;
+    }
+
+    tgUInt32 NumComponents = 0;
+
+    for( tgSize NodeIndex = 0; NodeIndex < NumNodes; ++NodeIndex )
+    {
+        const SNavMeshPolygon& rPolygon = pPolygons[NodeIndex];
+        if( rPolygon.NumVertices < 3 || rPolygon.NumVertices > MaxPolygonVertices || static_cast<tgSize>( rPolygon.FirstIndex ) + rPolygon.NumVertices > NumIndices || pComponents[NodeIndex] >= NumNodes )
+            return false;
+
+        NumComponents = std::max( NumComponents, pComponents[NodeIndex] + 1 );
+
+        // Links into other tiles are never cached, they are made again when the tiles are connected
+        for( const tgUInt32 NeighbourNode : pNeighbours[NodeIndex].Nodes )
+        {
+            if( NeighbourNode != INVALID_NODE && ( GetTileIndex( NeighbourNode ) != m_TileIndex || GetLocalNode( NeighbourNode ) >= NumNodes ) )
+                return false;
+        }
+    }
+
+    m_Centers.assign( pCenters, pCenters + NumNodes );
+    m_Neighbours.assign( pNeighbours, pNeighbours + NumNodes );
+    m_Portals.assign( pPortals, pPortals + NumNodes * MAX_POLYGON_VERTICES );
+    m_Polygons.assign( pPolygons, pPolygons + NumNodes );
+    m_Indices.assign( pIndices, pIndices + NumIndices );
+    m_Normals.assign( pNormals, pNormals + NumNodes );
+    m_Vertices.assign( pVertices, pVertices + NumFloatVertices );
+    m_QuantizedVertices.assign( pQuantizedVertices, pQuantizedVertices + NumQuantizedVertices );
+    std::copy( pQuantizationOrigin, pQuantizationOrigin + 3, m_QuantizationOrigin );
+    m_Components.assign( pComponents, pComponents + NumNodes );
+    m_NumComponents = NumComponents;
+
+    BuildBounds();
+    BuildNodeGrid();
+    return true;
+}
+
+void CNavMeshTile::SaveCache( const tgChar* pCacheFileName, const tgUInt64 SourceHash, const tgUInt32 MaxPolygonVertices ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::vector<SNavMeshNeighbours> Neighbours( m_Neighbours );
+    for( SNavMeshNeighbours& rNeighbours : Neighbours )
+    {
+        for( tgUInt32& rNeighbourNode : rNeighbours.Nodes )
+        {
+            if( rNeighbourNode != INVALID_NODE && GetTileIndex( rNeighbourNode ) != m_TileIndex )
+                rNeighbourNode = INVALID_NODE;
+        }
+    }
+
+    const std::vector<tgSInt32> QuantizationOrigin( m_QuantizationOrigin, m_QuantizationOrigin + 3 );
+
+    SCacheHeader Header{};
+    Header.Magic              = CacheTileMagic;
+    Header.Version            = CacheVersion;
+    Header.SourceHash         = SourceHash;
+    Header.NumSections        = NUM_CACHE_SECTIONS;
+    Header.MaxPolygonVertices = MaxPolygonVertices;
+
+    SCacheSection Sections[NUM_CACHE_SECTIONS]{};
+    tgUInt64      Offset = ( sizeof( Header ) + sizeof( Sections ) + 15 ) & ~static_cast<tgUInt64>( 15 );
+    SetCacheSection( Sections[CACHE_SECTION_VERTICES], m_Vertices, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_QUANTIZED_VERTICES], m_QuantizedVertices, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_QUANTIZATION_ORIGIN], QuantizationOrigin, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_INDICES], m_Indices, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_POLYGONS], m_Polygons, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_CENTERS], m_Centers, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_NORMALS], m_Normals, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_NEIGHBOURS], Neighbours, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_PORTALS], m_Portals, Offset );
+    SetCacheSection( Sections[CACHE_SECTION_COMPONENTS], m_Components, Offset );
+
+    std::vector<tgUInt8> Buffer( static_cast<tgSize>( Offset ), 0 );
+    memcpy( Buffer.data(), &Header, sizeof( Header ) );
+    memcpy( Buffer.data() + sizeof( Header ), Sections, sizeof( Sections ) );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_VERTICES], m_Vertices );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_QUANTIZED_VERTICES], m_QuantizedVertices );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_QUANTIZATION_ORIGIN], QuantizationOrigin );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_INDICES], m_Indices );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_POLYGONS], m_Polygons );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_CENTERS], m_Centers );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_NORMALS], m_Normals );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_NEIGHBOURS], Neighbours );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_PORTALS], m_Portals );
+    CopyCacheSection( Buffer, Sections[CACHE_SECTION_COMPONENTS], m_Components );
+
+    FILE* pFile = fopen( pCacheFileName, "wb" );
+    if( !pFile )
+        return;
+
+    fwrite( Buffer.data(), 1, Buffer.size(), pFile );
+    fclose( pFile );
+}
+
+void CNavMeshTile::BuildBounds( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    // Polygons are assigned to the tile by their center, so their vertices may reach past the tile square
+    const tgUInt32 NumVertices = static_cast<tgUInt32>( m_Vertices.size() + m_QuantizedVertices.size() );
+    if( !NumVertices )
+    {
+        m_Bounds.Set( tgCV3D( m_MinX, 0, m_MinZ ), tgCV3D( m_MinX + m_Size, 0, m_MinZ + m_Size ) );
+        return;
+    }
+
+    m_Bounds.Set( GetVertex( 0 ), GetVertex( 0 ) );
+    for( tgUInt32 VertexIndex = 1; VertexIndex < NumVertices; ++VertexIndex )
+        m_Bounds.AddPoint( GetVertex( VertexIndex ) );
+}
+
+void CNavMeshTile::BuildNodeGrid( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::vector<tgCAABox3D> NodeBoxes;
+    NodeBoxes.reserve( m_Polygons.size() );
+
+    for( tgUInt32 Node = 0; Node < m_Polygons.size(); ++Node )
+    {
+        tgCV3D         Vertices[MAX_POLYGON_VERTICES];
+        const tgUInt32 NumVertices = GetPolygon( Node, Vertices );
+
+        NodeBoxes.emplace_back( Vertices[0], Vertices[0] );
+        for( tgUInt32 i = 1; i < NumVertices; ++i )
+            NodeBoxes.back().AddPoint( Vertices[i] );
+    }
+
+    m_NodeGrid.Build( NodeBoxes );
+}
+
+tgBool CNavMeshTile::SegmentHitsBoundary( const tgCV3D& rStart, const tgCV3D& rEnd ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const tgCLine2D Segment( tgCV2D( rStart.x, rStart.z ), tgCV2D( rEnd.x, rEnd.z ) );
+
+    auto HitsCellEdges = [this, &Segment]( const tgUInt32 CellIndex )
+    {
+        tgUInt32        NumEdges     = 0;
+        const tgUInt32* pEdgeIndices = m_EdgeGrid.GetCellItems( CellIndex, NumEdges );
+
+        for( tgUInt32 i = 0; i < NumEdges; ++i )
+        {
+            if( m_BoundaryLines[pEdgeIndices[i]].Intersect( Segment ) )
+                return true;
+        }
+
+        return false;
+    };
+
+    return m_EdgeGrid.VisitSegmentCells( rStart.x, rStart.z, rEnd.x, rEnd.z, HitsCellEdges );
+}
+
+void CNavMeshTile::BuildEdgeGrid( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::vector<tgCAABox3D> EdgeBoxes;
+    EdgeBoxes.reserve( m_Edges.size() );
+    m_BoundaryLines.clear();
+    m_BoundaryLines.reserve( m_Edges.size() );
+
+    for( const tgCLine3D& rEdge : m_Edges )
+    {
+        EdgeBoxes.emplace_back( rEdge.GetStart(), rEdge.GetStart() );
+        EdgeBoxes.back().AddPoint( rEdge.GetEnd() );
+
+        m_BoundaryLines.emplace_back( tgCV2D( rEdge.GetStart().x, rEdge.GetStart().z ), tgCV2D( rEdge.GetEnd().x, rEdge.GetEnd().z ) );
+    }
+
+    m_EdgeGrid.Build( EdgeBoxes );
+}
+
+void CNavMeshTile::AddTriangle( const tgCV3D& rPosition0, const tgCV3D& rPosition1, const tgCV3D& rPosition2, const tgCV3D& rNormal )
+{
+    const tgCV3D Center = ( rPosition0 + rPosition1 + rPosition2 ) / 3;
+
+    // Sectors and triangle boxes overlap several tiles, every triangle belongs to the one tile its center lies in
+    if( Center.x < m_MinX || Center.z < m_MinZ || Center.x >= m_MinX + m_Size || Center.z >= m_MinZ + m_Size )
+        return;
+
+    // Every triangle gets its own vertices here, WeldVertices merges them into the shared pool afterwards
+    SNavMeshPolygon Polygon;
+    Polygon.FirstIndex  = static_cast<tgUInt32>( m_Indices.size() );
+    Polygon.NumVertices = 3;
+
+    SNavMeshNeighbours Neighbours;
+    std::fill( Neighbours.Nodes, Neighbours.Nodes + SNavMeshNeighbours::MAX_NEIGHBOURS, INVALID_NODE );
+
+    m_Centers.push_back( Center );
+    m_Neighbours.push_back( Neighbours );
+    m_Portals.resize( m_Portals.size() + MAX_POLYGON_VERTICES );
+    m_Polygons.push_back( Polygon );
+    m_Indices.push_back( static_cast<tgUInt32>( m_Vertices.size() ) );
+    m_Indices.push_back( static_cast<tgUInt32>( m_Vertices.size() + 1 ) );
+    m_Indices.push_back( static_cast<tgUInt32>( m_Vertices.size() + 2 ) );
+    m_Vertices.push_back( rPosition0 );
+    m_Vertices.push_back( rPosition1 );
+    m_Vertices.push_back( rPosition2 );
+    m_Normals.push_back( rNormal );
+}
+
+void CNavMeshTile::FinishBuild( const tgUInt32 MaxPolygonVertices, const tgBool ReorderNodes )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    WeldVertices();
+
+    if( MaxPolygonVertices > 3 )
+        MergePolygons( MaxPolygonVertices );
+
+    if( ReorderNodes )
+        SortNodes();
+
+    if( m_QuantizeVertices )
+        QuantizeVertices();
+
+    FindNeighbours();
+    FindComponents();
+
+    BuildBounds();
+    BuildNodeGrid();
+}
+
+void CNavMeshTile::WeldVertices( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::unordered_map<SVertexKey, tgUInt32, SVertexKeyHash> VertexIndices;
+    std::vector<tgCV3D>                                       Vertices;
+
+    VertexIndices.reserve( m_Vertices.size() / 2 );
+
+    // The first vertex in a cell stands in for all of them, so adjacency only has to compare indices
+    for( tgUInt32& rIndex : m_Indices )
+    {
+        const auto Result = VertexIndices.emplace( GetVertexKey( m_Vertices[rIndex], m_VertexScale ), static_cast<tgUInt32>( Vertices.size() ) );
+        if( Result.second )
+            Vertices.push_back( m_Vertices[rIndex] );
+
+        rIndex = Result.first->second;
+    }
+
+    m_Vertices.swap( Vertices );
+}
+
+void CNavMeshTile::MergePolygons( const tgUInt32 MaxPolygonVertices )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const tgUInt32 NumTriangles = static_cast<tgUInt32>( m_Polygons.size() );
+
+    std::vector<TMergePolygon>              Polygons( NumTriangles );
+    std::vector<tgCV3D>                     FaceNormals( NumTriangles );
+    std::unordered_map<tgUInt64, tgUInt32> DirectedEdges;
+
+    DirectedEdges.reserve( m_Indices.size() );
+
+    // Directed edges are keyed Start << 32 | End, the opposite key finds the neighbour holding the same edge
+    auto GetDirectedEdgeKey = []( const tgUInt32 Start, const tgUInt32 End ) { return ( static_cast<tgUInt64>( Start ) << 32 ) | End; };
+
+    for( tgUInt32 Polygon = 0; Polygon < NumTriangles; ++Polygon )
+    {
+        const SNavMeshPolygon& rPolygon = m_Polygons[Polygon];
+        Polygons[Polygon].assign( m_Indices.begin() + rPolygon.FirstIndex, m_Indices.begin() + rPolygon.FirstIndex + rPolygon.NumVertices );
+
+        const TMergePolygon& rIndices = Polygons[Polygon];
+        FaceNormals[Polygon].CrossProduct( m_Vertices[rIndices[1]] - m_Vertices[rIndices[0]], m_Vertices[rIndices[2]] - m_Vertices[rIndices[0]] );
+        FaceNormals[Polygon].Normalize();
+
+        for( tgUInt32 i = 0; i < rPolygon.NumVertices; ++i )
+            DirectedEdges.emplace( GetDirectedEdgeKey( rIndices[i], rIndices[( i + 1 ) % rPolygon.NumVertices] ), Polygon );
+    }
+
+    // Greedily grow every polygon over its longest mergeable edge until no neighbour fits
+    TMergePolygon Merged;
+    TMergePolygon BestMerged;
+
+    for( tgUInt32 Polygon = 0; Polygon < NumTriangles; ++Polygon )
+    {
+        TMergePolygon& rPolygon = Polygons[Polygon];
+
+        while( !rPolygon.empty() )
+        {
+            const tgCV3D& rNormal       = FaceNormals[Polygon];
+            tgUInt32      BestNeighbour = INVALID_NODE;
+            tgFloat       BestLength    = 0;
+            tgUInt64      BestEdge      = 0;
+
+            for( tgUInt32 Edge = 0; Edge < rPolygon.size(); ++Edge )
+            {
+                const tgUInt32 Start = rPolygon[Edge];
+                const tgUInt32 End   = rPolygon[( Edge + 1 ) % rPolygon.size()];
+                const auto     it    = DirectedEdges.find( GetDirectedEdgeKey( End, Start ) );
+
+                if( it == DirectedEdges.end() || it->second == Polygon || Polygons[it->second].empty() )
+                    continue;
+
+                const tgUInt32       Neighbour         = it->second;
+                const TMergePolygon& rNeighbourPolygon = Polygons[Neighbour];
+                const tgFloat        Length            = ( m_Vertices[End] - m_Vertices[Start] ).DotProduct();
+
+                if( Length <= BestLength || rPolygon.size() + rNeighbourPolygon.size() - 2 > MaxPolygonVertices || rNormal.DotProduct( FaceNormals[Neighbour] ) < .999f )
+                    continue;
+
+                tgBool IsCoplanar = true;
+                for( const tgUInt32 Vertex : rNeighbourPolygon )
+                    IsCoplanar &= tgMathAbs( rNormal.DotProduct( m_Vertices[Vertex] - m_Vertices[Start] ) ) < .01f;
+
+                if( !IsCoplanar || !JoinPolygons( rPolygon, Edge, rNeighbourPolygon, Merged ) || !IsConvexPolygon( Merged, m_Vertices, rNormal ) )
+                    continue;
+
+                BestNeighbour = Neighbour;
+                BestLength    = Length;
+                BestEdge      = GetDirectedEdgeKey( Start, End );
+                BestMerged.swap( Merged );
+            }
+
+            if( BestNeighbour == INVALID_NODE )
+                break;
+
+            // The shared edge is now interior, the rest of the neighbour's edges belong to this polygon
+            TMergePolygon& rNeighbourPolygon = Polygons[BestNeighbour];
+            for( tgUInt32 Edge = 0; Edge < rNeighbourPolygon.size(); ++Edge )
+            {
+                const auto it = DirectedEdges.find( GetDirectedEdgeKey( rNeighbourPolygon[Edge], rNeighbourPolygon[( Edge + 1 ) % rNeighbourPolygon.size()] ) );
+
+                if( it != DirectedEdges.end() && it->second == BestNeighbour )
+                    it->second = Polygon;
+            }
+
+            DirectedEdges.erase( BestEdge );
+            DirectedEdges.erase( ( BestEdge << 32 ) | ( BestEdge >> 32 ) );
+
+            rPolygon.swap( BestMerged );
+            rNeighbourPolygon.clear();
+        }
+    }
+
+    std::vector<tgCV3D>          Centers;
+    std::vector<SNavMeshPolygon> MergedPolygons;
+    std::vector<tgUInt32>        Indices;
+    std::vector<tgCV3D>          Normals;
+
+    for( tgUInt32 Polygon = 0; Polygon < NumTriangles; ++Polygon )
+    {
+        const TMergePolygon& rPolygon = Polygons[Polygon];
+        if( rPolygon.empty() )
+            continue;
+
+        SNavMeshPolygon MergedPolygon;
+        MergedPolygon.FirstIndex  = static_cast<tgUInt32>( Indices.size() );
+        MergedPolygon.NumVertices = static_cast<tgUInt32>( rPolygon.size() );
+
+        tgCV3D Center( 0 );
+        for( const tgUInt32 Vertex : rPolygon )
+        {
+            Indices.push_back( Vertex );
+            Center += m_Vertices[Vertex];
+        }
+
+        Centers.push_back( Center / static_cast<tgFloat>( rPolygon.size() ) );
+        MergedPolygons.push_back( MergedPolygon );
+        Normals.push_back( m_Normals[Polygon] );
+    }
+
+    SNavMeshNeighbours Neighbours;
+    std::fill( Neighbours.Nodes, Neighbours.Nodes + SNavMeshNeighbours::MAX_NEIGHBOURS, INVALID_NODE );
+
+    m_Centers.swap( Centers );
+    m_Polygons.swap( MergedPolygons );
+    m_Indices.swap( Indices );
+    m_Normals.swap( Normals );
+    m_Neighbours.assign( m_Polygons.size(), Neighbours );
+    m_Portals.assign( m_Polygons.size() * MAX_POLYGON_VERTICES, SNavMeshPortal() );
+}
+
+void CNavMeshTile::SortNodes( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const tgUInt32 NumNodes = static_cast<tgUInt32>( m_Centers.size() );
+    const tgFloat  Scale    = 65535.0f / m_Size;
+
+    // Sorting on the curve key keeps graph neighbours close in memory, nodes are sorted before any links refer to them
+    std::vector<std::pair<tgUInt32, tgUInt32>> SortedNodes( NumNodes );
+    for( tgUInt32 Node = 0; Node < NumNodes; ++Node )
+    {
+        const tgFloat X = tgMathClamp( 0.0f, ( m_Centers[Node].x - m_MinX ) * Scale, 65535.0f );
+        const tgFloat Z = tgMathClamp( 0.0f, ( m_Centers[Node].z - m_MinZ ) * Scale, 65535.0f );
+
+        SortedNodes[Node] = std::make_pair( GetHilbertIndex( static_cast<tgUInt32>( X ), static_cast<tgUInt32>( Z ) ), Node );
+    }
+
+    std::sort( SortedNodes.begin(), SortedNodes.end() );
+
+    std::vector<tgCV3D>          Centers;
+    std::vector<SNavMeshPolygon> Polygons;
+    std::vector<tgUInt32>        Indices;
+    std::vector<tgCV3D>          Normals;
+    std::vector<tgCV3D>          Vertices;
+    std::vector<tgUInt32>        VertexRemap( m_Vertices.size(), INVALID_NODE );
+
+    Centers.reserve( NumNodes );
+    Polygons.reserve( NumNodes );
+    Indices.reserve( m_Indices.size() );
+    Normals.reserve( NumNodes );
+    Vertices.reserve( m_Vertices.size() );
+
+    // Pool vertices follow the nodes in the order they are first used
+    for( const std::pair<tgUInt32, tgUInt32>& rSortedNode : SortedNodes )
+    {
+        const SNavMeshPolygon& rPolygon = m_Polygons[rSortedNode.second];
+
+        SNavMeshPolygon Polygon;
+        Polygon.FirstIndex  = static_cast<tgUInt32>( Indices.size() );
+        Polygon.NumVertices = rPolygon.NumVertices;
+
+        for( tgUInt32 i = 0; i < rPolygon.NumVertices; ++i )
+        {
+            const tgUInt32 Vertex = m_Indices[rPolygon.FirstIndex + i];
+            if( VertexRemap[Vertex] == INVALID_NODE )
+            {
+                VertexRemap[Vertex] = static_cast<tgUInt32>( Vertices.size() );
+                Vertices.push_back( m_Vertices[Vertex] );
+            }
+
+            Indices.push_back( VertexRemap[Vertex] );
+        }
+
+        Centers.push_back( m_Centers[rSortedNode.second] );
+        Polygons.push_back( Polygon );
+        Normals.push_back( m_Normals[rSortedNode.second] );
+    }
+
+    m_Centers.swap( Centers );
+    m_Polygons.swap( Polygons );
+    m_Indices.swap( Indices );
+    m_Normals.swap( Normals );
+    m_Vertices.swap( Vertices );
+}
+
+void CNavMeshTile::QuantizeVertices( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    if( m_Vertices.empty() )
+        return;
+
+    // The cells are the ones the vertices were welded on, so tiles sharing a vertex agree on it exactly
+    std::vector<SVertexKey> Keys;
+    Keys.reserve( m_Vertices.size() );
+
+    SVertexKey Min = GetVertexKey( m_Vertices[0], m_VertexScale );
+    SVertexKey Max = Min;
+
+    for( const tgCV3D& rVertex : m_Vertices )
+    {
+        Keys.push_back( GetVertexKey( rVertex, m_VertexScale ) );
+
+        Min.X = std::min( Min.X, Keys.back().X );
+        Min.Y = std::min( Min.Y, Keys.back().Y );
+        Min.Z = std::min( Min.Z, Keys.back().Z );
+        Max.X = std::max( Max.X, Keys.back().X );
+        Max.Y = std::max( Max.Y, Keys.back().Y );
+        Max.Z = std::max( Max.Z, Keys.back().Z );
+    }
+
+    if( static_cast<tgUInt32>( Max.X - Min.X ) > MAX_QUANTIZED_STEPS || static_cast<tgUInt32>( Max.Y - Min.Y ) > MAX_QUANTIZED_STEPS || static_cast<tgUInt32>( Max.Z - Min.Z ) > MAX_QUANTIZED_STEPS )
+        return;
+
+    m_QuantizationOrigin[0] = Min.X;
+    m_QuantizationOrigin[1] = Min.Y;
+    m_QuantizationOrigin[2] = Min.Z;
+
+    m_QuantizedVertices.resize( Keys.size() );
+    for( tgSize VertexIndex = 0; VertexIndex < Keys.size(); ++VertexIndex )
+    {
+        m_QuantizedVertices[VertexIndex].X = static_cast<tgUInt16>( Keys[VertexIndex].X - Min.X );
+        m_QuantizedVertices[VertexIndex].Y = static_cast<tgUInt16>( Keys[VertexIndex].Y - Min.Y );
+        m_QuantizedVertices[VertexIndex].Z = static_cast<tgUInt16>( Keys[VertexIndex].Z - Min.Z );
+    }
+
+    m_Vertices.clear();
+    m_Vertices.shrink_to_fit();
+}
+
+void CNavMeshTile::FindNeighbours( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::unordered_map<tgUInt64, tgUInt32> OpenEdges;
+    OpenEdges.reserve( m_Indices.size() / 2 );
+
+    for( tgUInt32 Node = 0; Node < m_Polygons.size(); ++Node )
+    {
+        const SNavMeshPolygon& rPolygon = m_Polygons[Node];
+        const tgUInt32*        pIndices = &m_Indices[rPolygon.FirstIndex];
+        tgCV3D                 Vertices[MAX_POLYGON_VERTICES];
+
+        GetPolygon( Node, Vertices );
+
+        for( tgUInt32 VertexIndex = 0; VertexIndex < rPolygon.NumVertices; VertexIndex++ )
+        {
+            const tgUInt32 Start = pIndices[VertexIndex];
+            const tgUInt32 End   = pIndices[( VertexIndex + 1 ) % rPolygon.NumVertices];
+
+            if( Start == End )
+                continue;
+
+            // Edge items are Node * MAX_POLYGON_VERTICES + VertexIndex, so a match knows the slot on both sides
+            const tgUInt64 EdgeKey = GetEdgeKey( Start, End );
+            const tgUInt32 Edge    = Node * MAX_POLYGON_VERTICES + VertexIndex;
+            const auto     it      = OpenEdges.find( EdgeKey );
+
+            if( it == OpenEdges.end() )
+            {
+                OpenEdges.emplace( EdgeKey, Edge );
+                continue;
+            }
+
+            const tgUInt32 NeighbourEdge = it->second;
+            const tgUInt32 NeighbourNode = NeighbourEdge / MAX_POLYGON_VERTICES;
+            OpenEdges.erase( it );
+
+            if( NeighbourNode == Node )
+                continue;
+
+            m_Neighbours[Node].Nodes[VertexIndex]                                  = GetNodeRef( m_TileIndex, NeighbourNode );
+            m_Neighbours[NeighbourNode].Nodes[NeighbourEdge % MAX_POLYGON_VERTICES] = GetNodeRef( m_TileIndex, Node );
+
+            SNavMeshPortal& rPortal          = m_Portals[Edge];
+            SNavMeshPortal& rNeighbourPortal = m_Portals[NeighbourEdge];
+            rPortal.Start                    = Vertices[VertexIndex];
+            rPortal.End                      = Vertices[( VertexIndex + 1 ) % rPolygon.NumVertices];
+            rNeighbourPortal.Start           = rPortal.End;
+            rNeighbourPortal.End             = rPortal.Start;
+        }
+    }
+}
+
+void CNavMeshTile::FindComponents( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::vector<tgUInt32> OpenNodes;
+
+    m_Components.assign( m_Centers.size(), INVALID_NODE );
+    m_NumComponents = 0;
+
+    // Flood fill every unlabelled node over the links that stay inside the tile
+    for( tgUInt32 FirstNode = 0; FirstNode < m_Components.size(); ++FirstNode )
+    {
+        if( m_Components[FirstNode] != INVALID_NODE )
+            continue;
+
+        m_Components[FirstNode] = m_NumComponents;
+        OpenNodes.push_back( FirstNode );
+
+        while( !OpenNodes.empty() )
+        {
+            const tgUInt32 Node = OpenNodes.back();
+            OpenNodes.pop_back();
+
+            for( const tgUInt32 NeighbourNode : m_Neighbours[Node].Nodes )
+            {
+                if( NeighbourNode == INVALID_NODE || GetTileIndex( NeighbourNode ) != m_TileIndex || m_Components[GetLocalNode( NeighbourNode )] != INVALID_NODE )
+                    continue;
+
+                m_Components[GetLocalNode( NeighbourNode )] = m_NumComponents;
+                OpenNodes.push_back( GetLocalNode( NeighbourNode ) );
+            }
+        }
+
+        ++m_NumComponents;
+    }
+}
+
+const SNavMeshPortal* CNavMeshTile::GetPortal( const tgUInt32 Node, const tgUInt32 NeighbourNode ) const
+{
+    for( tgUInt32 i = 0; i < MAX_POLYGON_VERTICES; ++i )
+    {
+        if( m_Neighbours[Node].Nodes[i] == NeighbourNode )
+            return &m_Portals[Node * MAX_POLYGON_VERTICES + i];
+    }
+
+    return nullptr;
+}
+
+void CNavMeshTile::FindEdges( const tgFloat MaxEdgeError )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::vector<tgCLine3D> Edges;
+
+    // Every polygon edge without a neighbour lies on the navmesh boundary, it is turned so its polygon is on the positive side of GetSide
+    for( tgUInt32 Node = 0; Node < m_Polygons.size(); ++Node )
+    {
+        tgCV3D         Vertices[MAX_POLYGON_VERTICES];
+        const tgUInt32 NumVertices = GetPolygon( Node, Vertices );
+        const tgCV3D&  rCenter     = m_Centers[Node];
+
+        for( tgUInt32 VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex )
+        {
+            if( m_Neighbours[Node].Nodes[VertexIndex] != INVALID_NODE )
+                continue;
+
+            const tgCV3D& rStart = Vertices[VertexIndex];
+            const tgCV3D& rEnd   = Vertices[( VertexIndex + 1 ) % NumVertices];
+
+            if( GetSide( rStart, rEnd, rCenter ) >= 0 )
+                Edges.emplace_back( rStart, rEnd );
+            else
+                Edges.emplace_back( rEnd, rStart );
+        }
+    }
+
+    FindContours( Edges, MaxEdgeError );
+    BuildEdgeGrid();
+
+    m_HasDirtyEdges = false;
+}
+
+tgBool CNavMeshTile::Connect( CNavMeshTile& rOtherTile )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::unordered_map<SEdgeKey, tgUInt32, SEdgeKeyHash> OpenEdges;
+
+    // Only edges that are still boundary on both sides can continue into the other tile, the pools differ so they are matched by position
+    for( tgUInt32 Node = 0; Node < rOtherTile.GetNumNodes(); ++Node )
+    {
+        tgCV3D         Vertices[MAX_POLYGON_VERTICES];
+        const tgUInt32 NumVertices = rOtherTile.GetPolygon( Node, Vertices );
+
+        for( tgUInt32 VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex )
+        {
+            if( rOtherTile.m_Neighbours[Node].Nodes[VertexIndex] != INVALID_NODE )
+                continue;
+
+            const SVertexKey Start = GetVertexKey( Vertices[VertexIndex], m_VertexScale );
+            const SVertexKey End   = GetVertexKey( Vertices[( VertexIndex + 1 ) % NumVertices], m_VertexScale );
+
+            if( !( Start == End ) )
+                OpenEdges.emplace( Start < End ? SEdgeKey{ Start, End } : SEdgeKey{ End, Start }, Node * MAX_POLYGON_VERTICES + VertexIndex );
+        }
+    }
+
+    tgBool Connected = false;
+    if( OpenEdges.empty() )
+        return Connected;
+
+    for( tgUInt32 Node = 0; Node < m_Polygons.size(); ++Node )
+    {
+        tgCV3D         Vertices[MAX_POLYGON_VERTICES];
+        const tgUInt32 NumVertices = GetPolygon( Node, Vertices );
+
+        for( tgUInt32 VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex )
+        {
+            if( m_Neighbours[Node].Nodes[VertexIndex] != INVALID_NODE )
+                continue;
+
+            const SVertexKey Start = GetVertexKey( Vertices[VertexIndex], m_VertexScale );
+            const SVertexKey End   = GetVertexKey( Vertices[( VertexIndex + 1 ) % NumVertices], m_VertexScale );
+            const auto       it    = OpenEdges.find( Start < End ? SEdgeKey{ Start, End } : SEdgeKey{ End, Start } );
+
+            if( it == OpenEdges.end() )
+                continue;
+
+            const tgUInt32 NeighbourEdge = it->second;
+            const tgUInt32 NeighbourNode = NeighbourEdge / MAX_POLYGON_VERTICES;
+            OpenEdges.erase( it );
+
+            m_Neighbours[Node].Nodes[VertexIndex]                                             = GetNodeRef( rOtherTile.m_TileIndex, NeighbourNode );
+            rOtherTile.m_Neighbours[NeighbourNode].Nodes[NeighbourEdge % MAX_POLYGON_VERTICES] = GetNodeRef( m_TileIndex, Node );
+
+            SNavMeshPortal& rPortal          = m_Portals[Node * MAX_POLYGON_VERTICES + VertexIndex];
+            SNavMeshPortal& rNeighbourPortal = rOtherTile.m_Portals[NeighbourEdge];
+            rPortal.Start                    = Vertices[VertexIndex];
+            rPortal.End                      = Vertices[( VertexIndex + 1 ) % NumVertices];
+            rNeighbourPortal.Start           = rPortal.End;
+            rNeighbourPortal.End             = rPortal.Start;
+
+            Connected = true;
+        }
+    }
+
+    if( Connected )
+    {
+        m_HasDirtyEdges            = true;
+        rOtherTile.m_HasDirtyEdges = true;
+    }
+
+    return Connected;
+}
+
+tgBool CNavMeshTile::Disconnect( const tgUInt32 OtherTileIndex )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    tgBool Disconnected = false;
+
+    for( SNavMeshNeighbours& rNeighbours : m_Neighbours )
+    {
+        for( tgUInt32& rNeighbourNode : rNeighbours.Nodes )
+        {
+            if( rNeighbourNode != INVALID_NODE && GetTileIndex( rNeighbourNode ) == OtherTileIndex )
+            {
+                rNeighbourNode = INVALID_NODE;
+                Disconnected   = true;
+            }
+        }
+    }
+
+    m_HasDirtyEdges = m_HasDirtyEdges || Disconnected;
+
+    return Disconnected;
+}
+
+void CNavMeshTile::FindContours( const std::vector<tgCLine3D>& rEdges, const tgFloat MaxEdgeError )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    // Edge ends are numbered Edge * 2 + End, every vertex keeps a linked list of the edge ends touching it
+    const tgUInt32                                             NumEdgeEnds = static_cast<tgUInt32>( rEdges.size() * 2 );
+    std::unordered_map<SVertexKey, tgUInt32, SVertexKeyHash> FirstEdgeEnds;
+    std::vector<tgUInt32>                                      NextEdgeEnds( NumEdgeEnds, INVALID_NODE );
+    std::vector<tgBool>                                        UsedEdges( rEdges.size(), false );
+
+    FirstEdgeEnds.reserve( rEdges.size() );
+
+    for( tgUInt32 EdgeEnd = 0; EdgeEnd < NumEdgeEnds; ++EdgeEnd )
+    {
+        const tgCLine3D& rEdge  = rEdges[EdgeEnd / 2];
+        const auto       Result = FirstEdgeEnds.emplace( GetVertexKey( EdgeEnd % 2 ? rEdge.GetEnd() : rEdge.GetStart(), m_VertexScale ), EdgeEnd );
+
+        if( !Result.second )
+        {
+            NextEdgeEnds[EdgeEnd] = Result.first->second;
+            Result.first->second  = EdgeEnd;
+        }
+    }
+
+    // Follows unused edges from the last point until the chain ends or closes on rFirstPoint
+    auto ExtendContour = [&]( std::vector<tgCV3D>& rPoints, const SVertexKey& rFirstPoint )
+    {
+        while( true )
+        {
+            const auto it = FirstEdgeEnds.find( GetVertexKey( rPoints.back(), m_VertexScale ) );
+            if( it == FirstEdgeEnds.end() )
+                return false;
+
+            tgUInt32 EdgeEnd = it->second;
+            while( EdgeEnd != INVALID_NODE && UsedEdges[EdgeEnd / 2] )
+                EdgeEnd = NextEdgeEnds[EdgeEnd];
+
+            if( EdgeEnd == INVALID_NODE )
+                return false;
+
+            UsedEdges[EdgeEnd / 2] = true;
+
+            const tgCLine3D& rEdge      = rEdges[EdgeEnd / 2];
+            const tgCV3D&    rNextPoint = EdgeEnd % 2 ? rEdge.GetStart() : rEdge.GetEnd();
+
+            if( GetVertexKey( rNextPoint, m_VertexScale ) == rFirstPoint )
+                return true;
+
+            rPoints.push_back( rNextPoint );
+        }
+    };
+
+    m_Contours.clear();
+
+    for( tgUInt32 EdgeIndex = 0; EdgeIndex < rEdges.size(); ++EdgeIndex )
+    {
+        const tgCLine3D& rEdge = rEdges[EdgeIndex];
+        if( UsedEdges[EdgeIndex] || GetVertexKey( rEdge.GetStart(), m_VertexScale ) == GetVertexKey( rEdge.GetEnd(), m_VertexScale ) )
+            continue;
+
+        UsedEdges[EdgeIndex] = true;
+
+        SNavMeshContour Contour;
+        Contour.Points.push_back( rEdge.GetStart() );
+        Contour.Points.push_back( rEdge.GetEnd() );
+        Contour.IsClosed = ExtendContour( Contour.Points, GetVertexKey( rEdge.GetStart(), m_VertexScale ) );
+
+        if( !Contour.IsClosed )
+        {
+            std::vector<tgCV3D> BackwardPoints = { Contour.Points[1], Contour.Points[0] };
+            ExtendContour( BackwardPoints, GetVertexKey( Contour.Points.back(), m_VertexScale ) );
+
+            if( BackwardPoints.size() > 2 || !( BackwardPoints[1] == Contour.Points[0] ) )
+            {
+                std::reverse( BackwardPoints.begin(), BackwardPoints.end() );
+                BackwardPoints.insert( BackwardPoints.end(), Contour.Points.begin() + 2, Contour.Points.end() );
+                Contour.Points = std::move( BackwardPoints );
+            }
+        }
+
+        SimplifyContour( Contour, MaxEdgeError );
+        m_Contours.push_back( std::move( Contour ) );
+    }
+
+    CreateContourEdges();
+}
+
+void CNavMeshTile::CreateContourEdges( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    m_Edges.clear();
+
+    for( const SNavMeshContour& rContour : m_Contours )
+    {
+        for( tgSize i = 0; i + 1 < rContour.Points.size(); ++i )
+            m_Edges.emplace_back( rContour.Points[i], rContour.Points[i + 1] );
+
+        if( rContour.IsClosed && rContour.Points.size() > 2 )
+            m_Edges.emplace_back( rContour.Points.back(), rContour.Points.front() );
+    }
+}
+
+void CNavMeshTile::SimplifyContour( SNavMeshContour& rContour, const tgFloat MaxEdgeError )
+{
+    std::vector<tgCV3D>& rPoints   = rContour.Points;
+    const tgSize         NumPoints = rPoints.size();
+
+    if( NumPoints < 3 )
+        return;
+
+    std::vector<tgBool> KeepPoints( NumPoints + 1, false );
+
+    if( rContour.IsClosed )
+    {
+        // A closed contour is split at the point furthest from its first point, both halves then end in points that are kept
+        tgSize  FurthestPoint    = 1;
+        tgFloat FurthestDistance = 0;
+
+        for( tgSize i = 1; i < NumPoints; ++i )
+        {
+            const tgFloat Distance = ( rPoints[i] - rPoints[0] ).DotProduct();
+            if( Distance > FurthestDistance )
+            {
+                FurthestDistance = Distance;
+                FurthestPoint    = i;
+            }
+        }
+
+        rPoints.push_back( rPoints[0] );
+        KeepPoints[0]             = true;
+        KeepPoints[FurthestPoint] = true;
+
+        SimplifyRun( rPoints, 0, FurthestPoint, MaxEdgeError, KeepPoints );
+        SimplifyRun( rPoints, FurthestPoint, NumPoints, MaxEdgeError, KeepPoints );
+
+        rPoints.pop_back();
+    }
+    else
+    {
+        KeepPoints[0]             = true;
+        KeepPoints[NumPoints - 1] = true;
+
+        SimplifyRun( rPoints, 0, NumPoints - 1, MaxEdgeError, KeepPoints );
+    }
+
+    tgSize NumKeptPoints = 0;
+    for( tgSize i = 0; i < NumPoints; ++i )
+    {
+        if( KeepPoints[i] )
+            rPoints[NumKeptPoints++] = rPoints[i];
+    }
+
+    rPoints.resize( NumKeptPoints );
+}
+
+void CNavMeshTile::SimplifyRun( const std::vector<tgCV3D>& rPoints, const tgSize First, const tgSize Last, const tgFloat MaxEdgeError, std::vector<tgBool>& rKeepPoints )
+{
+    const tgFloat MinError = std::max( MaxEdgeError, MIN_EDGE_ERROR );
+
+    // Runs still to be split, kept on a stack since long contours would recurse once per point on the build workers' small stacks
+    std::vector<std::pair<tgSize, tgSize>> Runs;
+    Runs.emplace_back( First, Last );
+
+    while( !Runs.empty() )
+    {
+        const tgSize RunFirst = Runs.back().first;
+        const tgSize RunLast  = Runs.back().second;
+        Runs.pop_back();
+
+        if( RunLast <= RunFirst + 1 )
+            continue;
+
+        const tgCV3D& rFirst      = rPoints[RunFirst];
+        const tgCV3D& rLast       = rPoints[RunLast];
+        const tgFloat ChordX      = rLast.x - rFirst.x;
+        const tgFloat ChordZ      = rLast.z - rFirst.z;
+        const tgFloat ChordLength = std::sqrt( ChordX * ChordX + ChordZ * ChordZ );
+
+        // The chord may only cut away walkable space, so any point on its walkable side forces a split, at the one furthest over
+        // Without such points the run is split at the point furthest on the other side, if it is further than the allowed error
+        tgSize  WorstPoint       = RunLast;
+        tgFloat WorstSide        = MIN_EDGE_ERROR;
+        tgSize  FurthestPoint    = RunLast;
+        tgFloat FurthestDistance = MinError;
+
+        for( tgSize i = RunFirst + 1; i < RunLast; ++i )
+        {
+            const tgFloat Side = ChordLength > 0 ? GetSide( rFirst, rLast, rPoints[i] ) / ChordLength : std::sqrt( ( rPoints[i] - rFirst ).DotProduct() );
+
+            if( Side > WorstSide )
+            {
+                WorstSide  = Side;
+                WorstPoint = i;
+            }
+            else if( -Side > FurthestDistance )
+            {
+                FurthestDistance = -Side;
+                FurthestPoint    = i;
+            }
+        }
+
+        const tgSize SplitPoint = WorstPoint != RunLast ? WorstPoint : FurthestPoint;
+        if( SplitPoint == RunLast )
+            continue;
+
+        rKeepPoints[SplitPoint] = true;
+
+        Runs.emplace_back( RunFirst, SplitPoint );
+        Runs.emplace_back( SplitPoint, RunLast );
+    }
+}
+
+tgFloat CNavMeshTile::GetSide( const tgCV3D& rStart, const tgCV3D& rEnd, const tgCV3D& rPoint )
+{
+    return ( rEnd.x - rStart.x ) * ( rPoint.z - rStart.z ) - ( rEnd.z - rStart.z ) * ( rPoint.x - rStart.x );
+}
+
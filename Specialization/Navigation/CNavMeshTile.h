@@ -0,0 +1,134 @@
+#pragma once
+
+#include "SNavMeshNeighbours.h"
+#include "SNavMeshPortal.h"
+#include "SNavMeshPolygon.h"
+#include "SNavMeshQuantizedVertex.h"
+#include "SNavMeshContour.h"
+#include "CNavMeshGrid.h"
+
+#include <tgCAABox3D.h>
+#include <tgCLine2D.h>
+
+#include <tgMemoryDisable.h>
+#include <vector>
+#include <tgMemoryEnable.h>
+
+// One fixed-size square of the navmesh, nodes are tile-local and neighbour slots hold node refs so they can point into other tiles
+class CNavMeshTile
+{
+public:
+    CNavMeshTile( const tgUInt32 TileIndex, const tgFloat MinX, const tgFloat MinZ, const tgFloat Size, const tgBool QuantizeVertices );
+    ~CNavMeshTile( void );
+
+    static constexpr tgUInt32 INVALID_NODE         = 0xFFFFFFFF;
+    static constexpr tgUInt32 MAX_POLYGON_VERTICES = SNavMeshNeighbours::MAX_NEIGHBOURS;
+
+    // A node ref is the tile index in the high bits and the tile-local node in the low bits
+    static constexpr tgUInt32 LOCAL_NODE_BITS = 20;
+    static constexpr tgUInt32 MAX_TILE_NODES  = ( 1U << LOCAL_NODE_BITS ) - 1;
+    static constexpr tgUInt32 MAX_TILES       = ( 1U << ( 32 - LOCAL_NODE_BITS ) ) - 1;
+
+    static tgUInt32 GetNodeRef( const tgUInt32 TileIndex, const tgUInt32 LocalNode ) { return ( TileIndex << LOCAL_NODE_BITS ) | LocalNode; }
+    static tgUInt32 GetTileIndex( const tgUInt32 NodeRef ) { return NodeRef >> LOCAL_NODE_BITS; }
+    static tgUInt32 GetLocalNode( const tgUInt32 NodeRef ) { return NodeRef & MAX_TILE_NODES; }
+
+    // Quantized vertices cover twice the tile size on every axis, tiles with geometry reaching further keep float vertices
+    static constexpr tgUInt32 MAX_QUANTIZED_STEPS = 0xFFFF;
+
+    // A source adds its triangles before the build is finished, a triangle only ends up in the tile its center lies in
+    void   AddTriangle( const tgCV3D& rPosition0, const tgCV3D& rPosition1, const tgCV3D& rPosition2, const tgCV3D& rNormal );
+    void   FinishBuild( const tgUInt32 MaxPolygonVertices, const tgBool ReorderNodes );
+    tgBool LoadCache( const tgChar* pCacheFileName, const tgUInt64 SourceHash, const tgUInt32 MaxPolygonVertices );
+    void   SaveCache( const tgChar* pCacheFileName, const tgUInt64 SourceHash, const tgUInt32 MaxPolygonVertices ) const;
+
+    // Links change which edges are boundary, building, loading, connecting and disconnecting leave the edges dirty until FindEdges runs
+    tgBool Connect( CNavMeshTile& rOtherTile );
+    tgBool Disconnect( const tgUInt32 OtherTileIndex );
+    void   FindEdges( const tgFloat MaxEdgeError );
+    tgBool HasDirtyEdges( void ) const { return m_HasDirtyEdges; }
+
+    tgUInt32 GetNode( const tgCV3D& rPoint ) const;
+    tgBool   IntersectsNode( const tgCLine3D& rLine, const tgUInt32 LocalNode ) const;
+
+    tgUInt32          GetIndex( void ) const { return m_TileIndex; }
+    tgUInt32          GetNumNodes( void ) const { return static_cast<tgUInt32>( m_Centers.size() ); }
+    tgUInt32          GetNumComponents( void ) const { return m_NumComponents; }
+    const tgCAABox3D& GetBounds( void ) const { return m_Bounds; }
+    tgBool            IsQuantized( void ) const { return !m_QuantizedVertices.empty(); }
+
+    const tgCV3D&             GetCenter( const tgUInt32 LocalNode ) const { return m_Centers[LocalNode]; }
+    const SNavMeshNeighbours& GetNeighbours( const tgUInt32 LocalNode ) const { return m_Neighbours[LocalNode]; }
+    const SNavMeshPortal*     GetPortal( const tgUInt32 LocalNode, const tgUInt32 NeighbourNode ) const;
+    tgUInt32                  GetPolygon( const tgUInt32 LocalNode, tgCV3D* pVertices ) const;
+    const tgCV3D&             GetNormal( const tgUInt32 LocalNode ) const { return m_Normals[LocalNode]; }
+    tgUInt32                  GetComponent( const tgUInt32 LocalNode ) const { return m_Components[LocalNode]; }
+
+    std::vector<SNavMeshContour>&       GetContours( void ) { return m_Contours; }
+    const std::vector<SNavMeshContour>& GetContours( void ) const { return m_Contours; }
+    std::vector<tgCLine3D>&             GetEdges( void ) { return m_Edges; }
+    const std::vector<tgCLine3D>&       GetEdges( void ) const { return m_Edges; }
+
+    tgBool SegmentHitsBoundary( const tgCV3D& rStart, const tgCV3D& rEnd ) const;
+
+    // Defined in CNavMeshTileRender.cpp, the only part of the tile that needs the engine
+    void Render( void ) const;
+
+private:
+    void WeldVertices( void );
+    void MergePolygons( const tgUInt32 MaxPolygonVertices );
+    void SortNodes( void );
+    void QuantizeVertices( void );
+    void FindNeighbours( void );
+    void FindComponents( void );
+
+    void FindContours( const std::vector<tgCLine3D>& rEdges, const tgFloat MaxEdgeError );
+    void CreateContourEdges( void );
+
+    void BuildBounds( void );
+    void BuildNodeGrid( void );
+    void BuildEdgeGrid( void );
+
+    tgCV3D GetVertex( const tgUInt32 VertexIndex ) const;
+
+    // Contour points closer than this to the simplified edge are always dropped, whatever error is allowed
+    static constexpr tgFloat MIN_EDGE_ERROR = .001f;
+
+    static void    SimplifyContour( SNavMeshContour& rContour, const tgFloat MaxEdgeError );
+    static void    SimplifyRun( const std::vector<tgCV3D>& rPoints, const tgSize First, const tgSize Last, const tgFloat MaxEdgeError, std::vector<tgBool>& rKeepPoints );
+    static tgFloat GetSide( const tgCV3D& rStart, const tgCV3D& rEnd, const tgCV3D& rPoint );
+
+    // Hot data touched by every search expansion, followed by the cold geometry
+    std::vector<tgCV3D>             m_Centers;
+    std::vector<SNavMeshNeighbours> m_Neighbours;
+    std::vector<SNavMeshPortal>     m_Portals;
+    std::vector<SNavMeshPolygon>    m_Polygons;
+    std::vector<tgUInt32>           m_Indices;
+    std::vector<tgCV3D>             m_Normals;
+
+    // Polygons share one vertex pool welded on a grid of m_VertexScale cells per unit, quantized tiles store the cells instead of floats
+    std::vector<tgCV3D>                  m_Vertices;
+    std::vector<SNavMeshQuantizedVertex> m_QuantizedVertices;
+    tgSInt32                             m_QuantizationOrigin[3];
+    tgFloat                              m_VertexScale;
+    tgBool                               m_QuantizeVertices;
+
+    // Islands reachable through links inside this tile, CNavMesh joins them over the links between tiles
+    std::vector<tgUInt32> m_Components;
+    tgUInt32              m_NumComponents;
+
+    std::vector<SNavMeshContour> m_Contours;
+    std::vector<tgCLine3D>       m_Edges;
+    tgBool                       m_HasDirtyEdges;
+
+    std::vector<tgCLine2D> m_BoundaryLines;
+
+    CNavMeshGrid m_NodeGrid;
+    CNavMeshGrid m_EdgeGrid;
+
+    tgCAABox3D m_Bounds;
+    tgUInt32   m_TileIndex;
+    tgFloat    m_MinX;
+    tgFloat    m_MinZ;
+    tgFloat    m_Size;
+};
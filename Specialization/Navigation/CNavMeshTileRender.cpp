@@ -0,0 +1,40 @@
+#include <tgSystem.h>
+
+#include "CNavMeshTile.h"
+
+#include <tgCProfiling.h>
+#include <tgCDebugManager.h>
+#include <tgCLine3D.h>
+#include <tgCTriangle3D.h>
+
+void CNavMeshTile::Render( void ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    tgCDebugManager& rDebugManager = tgCDebugManager::GetInstance();
+
+    for( tgUInt32 Node = 0; Node < m_Polygons.size(); ++Node )
+    {
+        tgCV3D         Vertices[MAX_POLYGON_VERTICES];
+        const tgUInt32 NumVertices = GetPolygon( Node, Vertices );
+
+        for( tgUInt32 i = 0; i < NumVertices; ++i )
+        {
+            const tgCV3D VertexToCenterDir = ( m_Centers[Node] - Vertices[i] ).Normalized();
+
+            Vertices[i] += VertexToCenterDir * .01f + m_Normals[Node] * .01f;
+        }
+
+        for( tgUInt32 i = 2; i < NumVertices; ++i )
+            rDebugManager.AddTriangle3D( tgCTriangle3D( Vertices[0], Vertices[i - 1], Vertices[i] ), tgCColor::Purple );
+    }
+
+    for( const tgCLine3D& rEdge : m_Edges )
+    {
+        tgCLine3D Line( rEdge.GetStart() + tgCV3D( 0, .01f, 0 ), rEdge.GetEnd() + tgCV3D( 0, .01f, 0 ) );
+
+        rDebugManager.AddLine3D( Line, tgCColor::Lime );
+    }
+}
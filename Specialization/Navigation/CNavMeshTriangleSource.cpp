@@ -0,0 +1,45 @@
+#include <tgSystem.h>
+
+#include "CNavMeshTriangleSource.h"
+#include "CNavMeshTile.h"
+
+#include <tgCProfiling.h>
+
+CNavMeshTriangleSource::CNavMeshTriangleSource( const std::vector<tgCV3D>& rVertices, const std::vector<tgUInt32>& rIndices )
+    : m_Vertices( rVertices )
+    , m_Indices( rIndices.begin(), rIndices.begin() + rIndices.size() / 3 * 3 )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+}
+
+tgBool CNavMeshTriangleSource::GetSectorBounds( const tgUInt32 SectorIndex, tgCAABox3D& rBounds ) const
+{
+    rBounds.Set( m_Vertices[m_Indices[SectorIndex * 3]], m_Vertices[m_Indices[SectorIndex * 3]] );
+    rBounds.AddPoint( m_Vertices[m_Indices[SectorIndex * 3 + 1]] );
+    rBounds.AddPoint( m_Vertices[m_Indices[SectorIndex * 3 + 2]] );
+
+    return true;
+}
+
+void CNavMeshTriangleSource::AddSectorTriangles( CNavMeshTile& rTile, const std::vector<tgUInt32>& rSectors ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    for( const tgUInt32 Triangle : rSectors )
+    {
+        const tgCV3D& rPosition0 = m_Vertices[m_Indices[Triangle * 3]];
+        const tgCV3D& rPosition1 = m_Vertices[m_Indices[Triangle * 3 + 1]];
+        const tgCV3D& rPosition2 = m_Vertices[m_Indices[Triangle * 3 + 2]];
+
+        // Plain triangles carry no normals, the face normal is turned up like the ones authored in the world
+        tgCV3D Normal( 0 );
+        Normal.CrossProduct( rPosition1 - rPosition0, rPosition2 - rPosition0 );
+        Normal.Normalize();
+
+        rTile.AddTriangle( rPosition0, rPosition1, rPosition2, Normal.y < 0 ? Normal * -1.0f : Normal );
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "INavMeshSource.h"
+
+#include <tgCV3D.h>
+
+// A plain triangle list where every three indices are one triangle and every triangle is a sector of its own
+class CNavMeshTriangleSource : public INavMeshSource
+{
+public:
+    CNavMeshTriangleSource( const std::vector<tgCV3D>& rVertices, const std::vector<tgUInt32>& rIndices );
+
+    tgUInt32 GetNumSectors( void ) const override { return static_cast<tgUInt32>( m_Indices.size() / 3 ); }
+    tgBool   GetSectorBounds( const tgUInt32 SectorIndex, tgCAABox3D& rBounds ) const override;
+    void     AddSectorTriangles( CNavMeshTile& rTile, const std::vector<tgUInt32>& rSectors ) const override;
+
+private:
+    std::vector<tgCV3D>   m_Vertices;
+    std::vector<tgUInt32> m_Indices;
+};
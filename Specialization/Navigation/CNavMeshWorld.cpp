@@ -0,0 +1,105 @@
+#include <tgSystem.h>
+
+#include "CNavMesh.h"
+#include "CNavMeshWorldSource.h"
+#include "CMappedFile.h"
+#include "Managers/CWorldManager.h"
+
+#include <tgCProfiling.h>
+#include <tgCWorld.h>
+#include <tgMath.h>
+
+#include <tgMemoryDisable.h>
+#include <cstdio>
+#include <cstring>
+#include <tgMemoryEnable.h>
+
+tgUInt64 HashFile( const tgChar* pFileName )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const CMappedFile File( pFileName );
+    if( !File.IsOpen() )
+        return 0;
+
+    tgUInt64       Hash  = 14695981039346656037ULL;
+    const tgUInt8* pData = File.GetData();
+    for( tgSize i = 0; i < File.GetSize(); ++i )
+        Hash = ( Hash ^ pData[i] ) * 1099511628211ULL;
+
+    return Hash;
+}
+
+CNavMesh::CNavMesh( const tgCString& rWorldName, const tgChar* pWorldFileName, const tgUInt32 MaxPolygonVertices, const tgFloat TileSize, const tgBool ReorderNodes, const tgBool QuantizeVertices, const tgFloat MaxEdgeError )
+    : m_Tiles()
+    , m_BuildTimes()
+    , m_TileLock()
+    , m_pSource( nullptr )
+    , m_TileSectors()
+    , m_ComponentOffsets()
+    , m_ComponentLabels()
+    , m_NumComponents( 0 )
+    , m_WorldFileName()
+    , m_SourceHash( 0 )
+    , m_MaxPolygonVertices( tgMathClamp( 3U, MaxPolygonVertices, MAX_POLYGON_VERTICES ) )
+    , m_ReorderNodes( ReorderNodes )
+    , m_QuantizeVertices( QuantizeVertices )
+    , m_MaxEdgeError( MaxEdgeError )
+    , m_OriginX( 0 )
+    , m_OriginZ( 0 )
+    , m_TileSize( TileSize )
+    , m_NumTilesX( 0 )
+    , m_NumTilesZ( 0 )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif
+
+    const tgCWorld* pWorld = CWorldManager::GetInstance().GetWorld( rWorldName );
+    if( !pWorld )
+        return;
+
+    m_pSource = new CNavMeshWorldSource( pWorld );
+
+    snprintf( m_WorldFileName, sizeof( m_WorldFileName ), "%s", pWorldFileName );
+
+    // The tiles depend on the requested tile size, node order and vertex format as much as on the world, so all of them are part of the hash the caches are checked against
+    const tgUInt64 FileHash = HashFile( pWorldFileName );
+    if( FileHash )
+    {
+        tgUInt32 TileSizeBits = 0;
+        memcpy( &TileSizeBits, &TileSize, sizeof( TileSizeBits ) );
+
+        m_SourceHash = ( FileHash ^ TileSizeBits ^ ( ReorderNodes ? 0x100000000ULL : 0 ) ^ ( QuantizeVertices ? 0x200000000ULL : 0 ) ) * 1099511628211ULL;
+    }
+
+    tgChar CacheFileName[256];
+    snprintf( CacheFileName, sizeof( CacheFileName ), "%s.navmesh", pWorldFileName );
+
+    if( !m_SourceHash || !LoadLayout( CacheFileName ) )
+    {
+        CreateLayout();
+
+        if( m_SourceHash )
+            SaveLayout( CacheFileName );
+    }
+
+    LoadAllTiles();
+}
+
+void CNavMesh::Render()
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    FindEdges();
+
+    for( const CNavMeshTile* pTile : m_Tiles )
+    {
+        if( pTile )
+            pTile->Render();
+    }
+}
@@ -0,0 +1,76 @@
+#include <tgSystem.h>
+
+#include "CNavMeshWorldSource.h"
+#include "CNavMeshTile.h"
+
+#include <tgCProfiling.h>
+#include <tgCMesh.h>
+#include <tgCWorld.h>
+
+CNavMeshWorldSource::CNavMeshWorldSource( const tgCWorld* pWorld )
+    : m_pWorld( pWorld )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+}
+
+tgUInt32 CNavMeshWorldSource::GetNumSectors( void ) const
+{
+    return m_pWorld->GetNumSectors();
+}
+
+tgBool CNavMeshWorldSource::GetSectorBounds( const tgUInt32 SectorIndex, tgCAABox3D& rBounds ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const tgSWorldSector* pSector     = m_pWorld->GetSector( SectorIndex );
+    tgBool                HasGeometry = false;
+
+    for( tgUInt32 MeshIndex = 0; MeshIndex < pSector->NumMeshes; ++MeshIndex )
+    {
+        const tgCMesh* pMesh = &pSector->pMeshArray[MeshIndex];
+
+        for( tgUInt32 IndiceIndex = 0; IndiceIndex < pMesh->GetNumTotalIndices(); ++IndiceIndex )
+        {
+            const tgCV3D& rPosition = pMesh->GetVertex( pMesh->GetIndex( IndiceIndex ) )->Position;
+
+            if( HasGeometry )
+                rBounds.AddPoint( rPosition );
+            else
+                rBounds.Set( rPosition, rPosition );
+
+            HasGeometry = true;
+        }
+    }
+
+    return HasGeometry;
+}
+
+void CNavMeshWorldSource::AddSectorTriangles( CNavMeshTile& rTile, const std::vector<tgUInt32>& rSectors ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    for( const tgUInt32 SectorIndex : rSectors )
+    {
+        const tgSWorldSector* pSector = m_pWorld->GetSector( SectorIndex );
+
+        for( tgUInt32 MeshIndex = 0; MeshIndex < pSector->NumMeshes; ++MeshIndex )
+        {
+            const tgCMesh* pMesh = &pSector->pMeshArray[MeshIndex];
+
+            for( tgUInt32 IndiceIndex = 0; IndiceIndex < pMesh->GetNumTotalIndices(); IndiceIndex += 3 )
+            {
+                const tgCMesh::SVertex* pVertex0 = pMesh->GetVertex( pMesh->GetIndex( IndiceIndex ) );
+                const tgCMesh::SVertex* pVertex1 = pMesh->GetVertex( pMesh->GetIndex( IndiceIndex + 1 ) );
+                const tgCMesh::SVertex* pVertex2 = pMesh->GetVertex( pMesh->GetIndex( IndiceIndex + 2 ) );
+
+                rTile.AddTriangle( pVertex0->Position, pVertex1->Position, pVertex2->Position, ( pVertex0->Normal + pVertex1->Normal + pVertex2->Normal ) / 3 );
+            }
+        }
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "INavMeshSource.h"
+
+// The meshes of a loaded world, sectors are the world sectors
+class CNavMeshWorldSource : public INavMeshSource
+{
+public:
+    CNavMeshWorldSource( const tgCWorld* pWorld );
+
+    tgUInt32 GetNumSectors( void ) const override;
+    tgBool   GetSectorBounds( const tgUInt32 SectorIndex, tgCAABox3D& rBounds ) const override;
+    void     AddSectorTriangles( CNavMeshTile& rTile, const std::vector<tgUInt32>& rSectors ) const override;
+
+private:
+    const tgCWorld* m_pWorld;
+};
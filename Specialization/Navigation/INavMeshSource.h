@@ -0,0 +1,23 @@
+#pragma once
+
+#include <tgCAABox3D.h>
+
+#include <tgMemoryDisable.h>
+#include <vector>
+#include <tgMemoryEnable.h>
+
+class CNavMeshTile;
+
+// Where CNavMesh takes its triangles from, grouped into sectors that the layout hands out to the tiles they overlap
+class INavMeshSource
+{
+public:
+    virtual ~INavMeshSource( void ) = default;
+
+    virtual tgUInt32 GetNumSectors( void ) const = 0;
+
+    // Returns false for a sector without any triangles
+    virtual tgBool GetSectorBounds( const tgUInt32 SectorIndex, tgCAABox3D& rBounds ) const = 0;
+
+    virtual void AddSectorTriangles( CNavMeshTile& rTile, const std::vector<tgUInt32>& rSectors ) const = 0;
+};
@@ -27,7 +27,10 @@ CPathfindingManager::CPathfindingManager( void )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    m_pSolver = new CAStarSolver( CLevel::GetInstance().GetNavMesh(), &m_Mutex );
+    m_CurrentPath.NavMeshStartNode = CNavMesh::INVALID_NODE;
+    m_CurrentPath.NavMeshGoalNode  = CNavMesh::INVALID_NODE;
+
+    m_pSolver = new CAStarSolver( CLevel::GetInstance().GetNavMesh() );
 
     UpdatePaths();
 
@@ -100,8 +103,8 @@ void CPathfindingManager::Update( const tgFloat DeltaTime )
         m_CurrentPath.StartPosition = *rOctreeObjects[tgMathRandom( 0, static_cast<tgSInt32>( rOctreeObjects.size() - 1 ) )]->GetPosition();
 
         CNavMesh* pNavMesh              = CLevel::GetInstance().GetNavMesh();
-        m_CurrentPath.pNavMeshGoalNode  = pNavMesh->GetNode( m_CurrentPath.GoalPosition );
-        m_CurrentPath.pNavMeshStartNode = pNavMesh->GetNode( m_CurrentPath.StartPosition );
+        m_CurrentPath.NavMeshGoalNode  = pNavMesh->GetNode( m_CurrentPath.GoalPosition, m_CurrentPath.NavMeshGoalNode );
+        m_CurrentPath.NavMeshStartNode = pNavMesh->GetNode( m_CurrentPath.StartPosition, m_CurrentPath.NavMeshStartNode );
 
         m_ThreadParams.IsStarting = true;
     }
@@ -124,7 +127,7 @@ void CPathfindingManager::Render( void )
 
         for( tgSize i = 0; i < rPathInfo.SharedPath->size() - 1; ++i )
         {
-            Line.Set( *rPathInfo.SharedPath->at( i ) + Offset, *rPathInfo.SharedPath->at( i + 1 ) + Offset );
+            Line.Set( rPathInfo.SharedPath->at( i ) + Offset, rPathInfo.SharedPath->at( i + 1 ) + Offset );
             rDebugManager.AddLine3D( Line, tgCColor::White );
         }
     }
@@ -190,27 +193,27 @@ void CPathfindingManager::FindPathThread( tgCThread* pThread )
 #endif // !FINAL
 
 
-        tgCTimer      Timer;
-        SNavMeshNode* pStartNode = nullptr;
-        SNavMeshNode* pGoalNode  = nullptr;
+        tgCTimer Timer;
+        tgUInt32 StartNode = CNavMesh::INVALID_NODE;
+        tgUInt32 GoalNode  = CNavMesh::INVALID_NODE;
         {
             tgCMutexScopeLock ScopeMutex( rMutex );
             pParams->IsStopping = false;
             pParams->IsStarting = false;
-            pStartNode          = rPathInfo.pNavMeshStartNode;
-            pGoalNode           = rPathInfo.pNavMeshGoalNode;
-            if( !pStartNode || !pGoalNode || ( pStartNode == pGoalNode ) )
+            StartNode           = rPathInfo.NavMeshStartNode;
+            GoalNode            = rPathInfo.NavMeshGoalNode;
+            if( StartNode == CNavMesh::INVALID_NODE || GoalNode == CNavMesh::INVALID_NODE || ( StartNode == GoalNode ) )
             {
                 rPathInfo.PathfindingCompleted = true;
                 continue;
             }
         }
 
-        const CSolver::EResult Result = pPathfindingManager->m_pSolver->FindPath( pStartNode, pGoalNode, pParams->IsStopping );
+        const CSolver::EResult Result = pPathfindingManager->m_pSolver->FindPath( StartNode, GoalNode, pParams->IsStopping );
 
         tgCMutexScopeLock ScopeMutex( rMutex );
         if( Result == CSolver::PATH_FOUND )
-            rPathInfo.SharedPath.reset( new std::vector<const tgCV3D*>( pPathfindingManager->m_pSolver->GetFunneledPath() ) );
+            rPathInfo.SharedPath.reset( new std::vector<tgCV3D>( pPathfindingManager->m_pSolver->GetFunneledPath() ) );
 
         pPathfindingManager->m_LatestPathfindingTime = Timer.GetLifeTime() * 1000;
         pPathfindingManager->m_PathfindingTimes.push_back( pPathfindingManager->m_LatestPathfindingTime );
@@ -251,8 +254,7 @@ void CPathfindingManager::UpdatePaths( void )
             rPathInfo.WeakPath.reset();
     }
 
-    const std::vector<SOctreeNode*> Nodes = CLevel::GetInstance().GetOctree()->GetNodesWithObjects();
-    for( const SOctreeNode* pOctreeNode : Nodes )
+    for( const SOctreeNode* pOctreeNode : CLevel::GetInstance().GetOctree()->GetOccupiedLeaves() )
     {
         {
             tgCMutexScopeLock ScopeMutex( m_Mutex );
@@ -276,8 +278,8 @@ void CPathfindingManager::UpdatePaths( void )
             PathInfo.PathfindingCompleted = false;
             PathInfo.StartPosition        = *pOctreeNode->Objects[0]->GetPosition();
             PathInfo.GoalPosition         = tgCV3D::Zero;
-            PathInfo.pNavMeshStartNode    = nullptr;
-            PathInfo.pNavMeshGoalNode     = nullptr;
+            PathInfo.NavMeshStartNode     = CNavMesh::INVALID_NODE;
+            PathInfo.NavMeshGoalNode      = CNavMesh::INVALID_NODE;
             PathInfo.pOctreeStartNode     = pOctreeNode;
 
             m_Paths.push_back( std::move( PathInfo ) );
@@ -291,7 +293,7 @@ void CPathfindingManager::UpdatePaths( void )
 
         for( tgUInt32 i = 0; i < rPathInfo1.SharedPath->size() - 1; ++i )
         {
-            tgCLine3D Line( *rPathInfo1.SharedPath->at( i ), *rPathInfo1.SharedPath->at( i + 1 ) );
+            tgCLine3D Line( rPathInfo1.SharedPath->at( i ), rPathInfo1.SharedPath->at( i + 1 ) );
 
             for( SPathInfo& rPathInfo2 : m_Paths )
             {
@@ -19,15 +19,15 @@ class CPathfindingManager
 public:
     struct SPathInfo
     {
-        tgBool                                      PathfindingCompleted;
-        std::shared_ptr<std::vector<const tgCV3D*>> SharedPath;
-        std::weak_ptr<std::vector<const tgCV3D*>>   WeakPath;
+        tgBool                               PathfindingCompleted;
+        std::shared_ptr<std::vector<tgCV3D>> SharedPath;
+        std::weak_ptr<std::vector<tgCV3D>>   WeakPath;
 
         tgCV3D StartPosition;
         tgCV3D GoalPosition;
 
-        SNavMeshNode* pNavMeshStartNode;
-        SNavMeshNode* pNavMeshGoalNode;
+        tgUInt32 NavMeshStartNode;
+        tgUInt32 NavMeshGoalNode;
 
         const SOctreeNode* pOctreeStartNode;
     };
@@ -1,7 +1,5 @@
 #pragma once
 
-#include "Navigation/SNavMeshNode.h"
-
 typedef float tgFloat;
 
 struct SAStarNode
@@ -13,13 +11,13 @@ struct SAStarNode
     SAStarNode( SAStarNode&& ) = default;
 
     SAStarNode( void )
-        : pThisNode( nullptr )
+        : NodeIndex( 0xFFFFFFFF )
         , G( 0 )
         , H( 0 )
         , F( 0 )
     { }
 
-    SNavMeshNode* pThisNode;
+    tgUInt32 NodeIndex;
 
     tgFloat G;
     tgFloat H;
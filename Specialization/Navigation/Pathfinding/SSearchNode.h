@@ -0,0 +1,9 @@
+#pragma once
+
+// A node counts as visited or closed only while its generation matches the solver's current search
+struct SSearchNode
+{
+    tgUInt32 ParentNode;
+    tgUInt32 VisitedGeneration;
+    tgUInt32 ClosedGeneration;
+};
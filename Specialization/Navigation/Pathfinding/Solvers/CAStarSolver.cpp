@@ -10,22 +10,14 @@
 
 tgBool SortAscendingF( const SAStarNode* pNode1, const SAStarNode* pNode2 ) { return pNode1->F < pNode2->F; }
 
-CAStarSolver::CAStarSolver( CNavMesh* pNavMesh, tgCMutex* pMutex )
-    : CSolver( pNavMesh, pMutex )
+CAStarSolver::CAStarSolver( const CNavMesh* pNavMesh )
+    : CSolver( pNavMesh )
     , m_SortedByF()
     , m_AStarNodes()
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
-
-    tgCMutexScopeLock ScopeMutex( *pMutex );
-
-    for( tgUInt32 i = 0; i < pNavMesh->GetNodes().size(); i++ )
-    {
-        m_AStarNodes.emplace_back();
-        m_AStarNodes.back().pThisNode = pNavMesh->GetNode( i );
-    }
 }
 
 CAStarSolver::~CAStarSolver( void )
@@ -44,41 +36,46 @@ tgBool CAStarSolver::Search( void )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    if( m_pCurrentNode == m_pGoalNode )
+    if( m_CurrentNode == m_GoalNode )
         return true;
 
-    if( m_pCurrentNode == m_pStartNode )
+    // Costs are only valid for nodes visited during this search, so the start has to be reset explicitly
+    if( m_CurrentNode == m_StartNode )
     {
-        SAStarNode* pStartNode = &m_AStarNodes[m_pStartNode->Index];
-        pStartNode->pThisNode  = m_pStartNode;
+        SAStarNode& rStartNode = GetAStarNode( m_StartNode );
+        rStartNode.G           = 0;
+        rStartNode.H           = 0;
+        rStartNode.F           = 0;
     }
 
-    for( SNavMeshNode* pNeighbourNode : m_pCurrentNode->NeighbourNodes )
+    for( const tgUInt32 NeighbourNode : m_pNavMesh->GetNeighbours( m_CurrentNode ).Nodes )
     {
-        if( pNeighbourNode->IsClosed )
+        if( NeighbourNode == CNavMesh::INVALID_NODE )
+            continue;
+
+        if( IsClosed( NeighbourNode ) )
             continue;
 
-        const SAStarNode* pCurrentAStarNode = &m_AStarNodes[m_pCurrentNode->Index];
+        const SAStarNode* pCurrentAStarNode = &GetAStarNode( m_CurrentNode );
 
-        const tgFloat G = CalculateG( pCurrentAStarNode, pNeighbourNode );
-        const tgFloat H = CalculateH( pNeighbourNode );
+        const tgFloat G = CalculateG( pCurrentAStarNode, NeighbourNode );
+        const tgFloat H = CalculateH( NeighbourNode );
         const tgFloat F = G + H;
 
-        SAStarNode* pNeighbourAStarNode = &m_AStarNodes[pNeighbourNode->Index];
-        if( pNeighbourNode->IsVisited )
+        SAStarNode* pNeighbourAStarNode = &GetAStarNode( NeighbourNode );
+        if( IsVisited( NeighbourNode ) )
         {
             if( F < pNeighbourAStarNode->F )
             {
-                pNeighbourNode->pParentNode = m_pCurrentNode;
-                pNeighbourAStarNode->G      = G;
-                pNeighbourAStarNode->H      = H;
-                pNeighbourAStarNode->F      = F;
+                SetVisited( NeighbourNode, m_CurrentNode );
+                pNeighbourAStarNode->G = G;
+                pNeighbourAStarNode->H = H;
+                pNeighbourAStarNode->F = F;
             }
         }
         else
         {
-            pNeighbourNode->pParentNode = m_pCurrentNode;
-            pNeighbourNode->IsVisited   = true;
+            SetVisited( NeighbourNode, m_CurrentNode );
 
             pNeighbourAStarNode->G = G;
             pNeighbourAStarNode->H = H;
@@ -92,55 +89,80 @@ tgBool CAStarSolver::Search( void )
     if( m_SortedByF.empty() )
         return true;
 
-    m_pCurrentNode           = m_SortedByF.front()->pThisNode;
-    m_pCurrentNode->IsClosed = true;
+    m_CurrentNode = m_SortedByF.front()->NodeIndex;
+    SetClosed( m_CurrentNode );
     m_SortedByF.erase( m_SortedByF.begin() );
 
     return false;
 }
 
-void CAStarSolver::Clear( void )
+void CAStarSolver::PrepareSearch( void )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    m_SortedByF.clear();
+    CSolver::PrepareSearch();
+
+    // The open list points into these, so they may only grow or shrink between searches
+    m_AStarNodes.resize( m_pNavMesh->GetNumTiles() );
 
-    for( SAStarNode& rNode : m_AStarNodes )
+    for( tgUInt32 TileIndex = 0; TileIndex < m_pNavMesh->GetNumTiles(); ++TileIndex )
     {
-        rNode.G = 0;
-        rNode.H = 0;
-        rNode.F = 0;
+        const CNavMeshTile*      pTile       = m_pNavMesh->GetTile( TileIndex );
+        const tgUInt32           NumNodes    = pTile ? pTile->GetNumNodes() : 0;
+        std::vector<SAStarNode>& rAStarNodes = m_AStarNodes[TileIndex];
 
-        rNode.pThisNode->pParentNode = nullptr;
-        rNode.pThisNode->IsClosed    = false;
-        rNode.pThisNode->IsVisited   = false;
+        if( rAStarNodes.size() > NumNodes )
+            rAStarNodes.resize( NumNodes );
+
+        for( tgUInt32 LocalNode = static_cast<tgUInt32>( rAStarNodes.size() ); LocalNode < NumNodes; ++LocalNode )
+        {
+            rAStarNodes.emplace_back();
+            rAStarNodes.back().NodeIndex = CNavMesh::GetNodeRef( TileIndex, LocalNode );
+        }
     }
 }
 
-tgFloat CAStarSolver::CalculateG( const SAStarNode* pCurrentNode, const SNavMeshNode* pNeighbourNode )
+void CAStarSolver::Clear( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    m_SortedByF.clear();
+
+    CSolver::Clear();
+}
+
+tgFloat CAStarSolver::CalculateG( const SAStarNode* pCurrentNode, const tgUInt32 NeighbourNode )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    const tgFloat X = pNeighbourNode->Center.x - pCurrentNode->pThisNode->Center.x;
-    const tgFloat Y = pNeighbourNode->Center.y - pCurrentNode->pThisNode->Center.y;
-    const tgFloat Z = pNeighbourNode->Center.z - pCurrentNode->pThisNode->Center.z;
+    const tgCV3D& rNeighbourCenter = m_pNavMesh->GetCenter( NeighbourNode );
+    const tgCV3D& rCurrentCenter   = m_pNavMesh->GetCenter( pCurrentNode->NodeIndex );
+
+    const tgFloat X = rNeighbourCenter.x - rCurrentCenter.x;
+    const tgFloat Y = rNeighbourCenter.y - rCurrentCenter.y;
+    const tgFloat Z = rNeighbourCenter.z - rCurrentCenter.z;
 
     return pCurrentNode->G + ( X * X ) + ( Y * Y ) + ( Z * Z );
 }
 
-tgFloat CAStarSolver::CalculateH( const SNavMeshNode* pNeighbourNode )
+tgFloat CAStarSolver::CalculateH( const tgUInt32 NeighbourNode )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    const tgFloat X = m_pGoalNode->Center.x - pNeighbourNode->Center.x;
-    const tgFloat Y = m_pGoalNode->Center.y - pNeighbourNode->Center.y;
-    const tgFloat Z = m_pGoalNode->Center.z - pNeighbourNode->Center.z;
+    const tgCV3D& rGoalCenter      = m_pNavMesh->GetCenter( m_GoalNode );
+    const tgCV3D& rNeighbourCenter = m_pNavMesh->GetCenter( NeighbourNode );
+
+    const tgFloat X = rGoalCenter.x - rNeighbourCenter.x;
+    const tgFloat Y = rGoalCenter.y - rNeighbourCenter.y;
+    const tgFloat Z = rGoalCenter.z - rNeighbourCenter.z;
 
     return ( X * X ) + ( Y * Y ) + ( Z * Z );
 }
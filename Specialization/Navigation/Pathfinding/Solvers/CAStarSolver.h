@@ -6,17 +6,20 @@
 class CAStarSolver : public CSolver
 {
 public:
-    CAStarSolver( CNavMesh* pNavMesh, tgCMutex* pMutex );
+    CAStarSolver( const CNavMesh* pNavMesh );
     ~CAStarSolver( void ) override;
 
 private:
     tgBool Search( void ) override;
 
+    void PrepareSearch( void ) override;
     void Clear( void ) override;
 
-    tgFloat CalculateG( const SAStarNode* pCurrentNode, const SNavMeshNode* pNeighbourNode );
-    tgFloat CalculateH( const SNavMeshNode* pNeighbourNode );
+    SAStarNode& GetAStarNode( const tgUInt32 Node ) { return m_AStarNodes[CNavMesh::GetTileIndex( Node )][CNavMesh::GetLocalNode( Node )]; }
 
-    std::vector<SAStarNode*> m_SortedByF;
-    std::vector<SAStarNode>  m_AStarNodes;
+    tgFloat CalculateG( const SAStarNode* pCurrentNode, const tgUInt32 NeighbourNode );
+    tgFloat CalculateH( const tgUInt32 NeighbourNode );
+
+    std::vector<SAStarNode*>              m_SortedByF;
+    std::vector<std::vector<SAStarNode>> m_AStarNodes;
 };
@@ -4,36 +4,69 @@
 #include "Navigation/CNavMesh.h"
 
 #include <tgCProfiling.h>
-#include <tgCLine3D.h>
-#include <tgCLine2D.h>
 
-CSolver::CSolver( CNavMesh* pNavMesh, tgCMutex* pMutex )
+// Twice the signed area of the triangle projected onto the XZ plane
+tgFloat TriangleArea2D( const tgCV3D& rPoint1, const tgCV3D& rPoint2, const tgCV3D& rPoint3 )
+{
+    const tgFloat X1 = rPoint2.x - rPoint1.x;
+    const tgFloat Z1 = rPoint2.z - rPoint1.z;
+    const tgFloat X2 = rPoint3.x - rPoint1.x;
+    const tgFloat Z2 = rPoint3.z - rPoint1.z;
+
+    return ( X2 * Z1 ) - ( X1 * Z2 );
+}
+
+tgBool IsSamePoint2D( const tgCV3D& rPoint1, const tgCV3D& rPoint2 )
+{
+    const tgFloat X = rPoint2.x - rPoint1.x;
+    const tgFloat Z = rPoint2.z - rPoint1.z;
+
+    return ( X * X ) + ( Z * Z ) < .000001f;
+}
+
+CSolver::CSolver( const CNavMesh* pNavMesh )
     : m_FunneledPath()
+    , m_LeftPortalPoints()
+    , m_RightPortalPoints()
     , m_pNavMesh( pNavMesh )
-    , m_pStartNode( nullptr )
-    , m_pGoalNode( nullptr )
-    , m_pCurrentNode( nullptr )
-    , m_pMutex( pMutex )
+    , m_SearchNodes()
+    , m_SearchGeneration( 1 )
+    , m_NumExpandedNodes( 0 )
+    , m_StartNode( CNavMesh::INVALID_NODE )
+    , m_GoalNode( CNavMesh::INVALID_NODE )
+    , m_CurrentNode( CNavMesh::INVALID_NODE )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 }
 
-CSolver::EResult CSolver::FindPath( SNavMeshNode* pStartNode, SNavMeshNode* pGoalNode, const tgBool& rStopping )
+CSolver::EResult CSolver::FindPath( const tgUInt32 StartNode, const tgUInt32 GoalNode, const tgBool& rStopping )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    m_pMutex->Lock();
+    // The tiles cannot be streamed while they are searched, the found path is copied out before the lock is released
+    std::shared_lock<std::shared_timed_mutex> TileLock( m_pNavMesh->GetTileLock() );
+
     m_FunneledPath.clear();
-    m_pStartNode            = pStartNode;
-    m_pStartNode->IsClosed  = true;
-    m_pStartNode->IsVisited = true;
-    m_pCurrentNode          = m_pStartNode;
-    m_pGoalNode             = pGoalNode;
-    m_pMutex->Unlock();
+
+    // Nodes are only valid while their tile is loaded
+    if( !m_pNavMesh->IsValidNode( StartNode ) || !m_pNavMesh->IsValidNode( GoalNode ) )
+        return PATH_NOT_FOUND;
+
+    // A goal on another island would only be rejected after the search has flooded the whole start island
+    if( m_pNavMesh->GetComponent( StartNode ) != m_pNavMesh->GetComponent( GoalNode ) )
+        return PATH_NOT_FOUND;
+
+    m_StartNode   = StartNode;
+    m_CurrentNode = StartNode;
+    m_GoalNode    = GoalNode;
+
+    PrepareSearch();
+    SetVisited( StartNode, CNavMesh::INVALID_NODE );
+    SetClosed( StartNode );
 
     tgBool Searching = false;
     while( !Searching )
@@ -41,11 +74,15 @@ CSolver::EResult CSolver::FindPath( SNavMeshNode* pStartNode, SNavMeshNode* pGoa
         if( rStopping )
             break;
 
+        // Search returns right away once the goal is the current node, every other call expands the current node
+        if( m_CurrentNode != m_GoalNode )
+            ++m_NumExpandedNodes;
+
         Searching = Search();
     }
 
-    std::vector<SNavMeshNode*> Path;
-    const tgBool               FoundPath = GetPath( Path, rStopping );
+    std::vector<tgUInt32> Path;
+    const tgBool          FoundPath = GetPath( Path, rStopping );
 
     Clear();
     if( FoundPath && !Path.empty() )
@@ -60,25 +97,24 @@ CSolver::EResult CSolver::FindPath( SNavMeshNode* pStartNode, SNavMeshNode* pGoa
     }
 }
 
-tgBool CSolver::GetPath( std::vector<SNavMeshNode*>& rPath, const tgBool& rStopping )
+tgBool CSolver::GetPath( std::vector<tgUInt32>& rPath, const tgBool& rStopping )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
     rPath.clear();
-    if( m_pCurrentNode != m_pGoalNode )
+    if( m_CurrentNode != m_GoalNode )
         return false;
 
-    SNavMeshNode* pNode = m_pCurrentNode;
+    tgUInt32 Node = m_CurrentNode;
 
-    while( pNode != m_pStartNode )
+    while( Node != m_StartNode )
     {
-        rPath.insert( rPath.begin(), pNode );
+        rPath.push_back( Node );
 
-        if( pNode->pParentNode )
-            pNode = pNode->pParentNode;
-        else
+        Node = GetSearchNode( Node ).ParentNode;
+        if( Node == CNavMesh::INVALID_NODE )
             return false;
 
         if( rStopping )
@@ -88,74 +124,122 @@ tgBool CSolver::GetPath( std::vector<SNavMeshNode*>& rPath, const tgBool& rStopp
         }
     }
 
-    rPath.insert( rPath.begin(), pNode );
+    rPath.push_back( Node );
+    std::reverse( rPath.begin(), rPath.end() );
     return true;
 }
 
-void CSolver::FunnelPath( const std::vector<SNavMeshNode*>& rPath )
+void CSolver::FunnelPath( const std::vector<tgUInt32>& rPath )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
+    const tgCV3D* pStartPoint = &m_pNavMesh->GetCenter( m_StartNode );
+    const tgCV3D* pGoalPoint  = &m_pNavMesh->GetCenter( m_GoalNode );
+
+    // The corridor as seen walking along the path, the start and goal are zero width portals
+    m_LeftPortalPoints.clear();
+    m_RightPortalPoints.clear();
+    m_LeftPortalPoints.push_back( pStartPoint );
+    m_RightPortalPoints.push_back( pStartPoint );
+
+    for( tgSize i = 0; i + 1 < rPath.size(); ++i )
+    {
+        const SNavMeshPortal* pPortal = m_pNavMesh->GetPortal( rPath[i], rPath[i + 1] );
+        if( !pPortal )
+            continue;
+
+        // Portals follow the winding of the node being left, so which end is left depends on the mesh
+        if( TriangleArea2D( m_pNavMesh->GetCenter( rPath[i] ), pPortal->Start, pPortal->End ) > 0 )
+        {
+            m_LeftPortalPoints.push_back( &pPortal->Start );
+            m_RightPortalPoints.push_back( &pPortal->End );
+        }
+        else
+        {
+            m_LeftPortalPoints.push_back( &pPortal->End );
+            m_RightPortalPoints.push_back( &pPortal->Start );
+        }
+    }
+
+    m_LeftPortalPoints.push_back( pGoalPoint );
+    m_RightPortalPoints.push_back( pGoalPoint );
+
     m_FunneledPath.clear();
-    m_FunneledPath.push_back( &m_pStartNode->Center );
+    m_FunneledPath.push_back( *pStartPoint );
 
-    const std::vector<tgCLine3D>& rNavMeshEdges = m_pNavMesh->GetEdges();
+    const tgCV3D* pApex       = pStartPoint;
+    const tgCV3D* pLeftPoint  = pStartPoint;
+    const tgCV3D* pRightPoint = pStartPoint;
+    tgSize        LeftIndex   = 0;
+    tgSize        RightIndex  = 0;
 
-    tgUInt32 StartIndex        = 0;
-    tgSInt32 NodesLeftToFunnel = rPath.size();
-    while( NodesLeftToFunnel > 1 )
+    for( tgSize i = 1; i < m_LeftPortalPoints.size(); ++i )
     {
-        tgUInt32 GoalIndex         = rPath.size() - 1;
-        tgUInt32 IndexChangeAmount = GoalIndex - StartIndex;
-        do
+        const tgCV3D* pLeft  = m_LeftPortalPoints[i];
+        const tgCV3D* pRight = m_RightPortalPoints[i];
+
+        // Tighten the right side, crossing over the left side turns the left point into a corner
+        if( TriangleArea2D( *pApex, *pRightPoint, *pRight ) <= 0 )
         {
-            if( GoalIndex >= rPath.size() )
+            if( IsSamePoint2D( *pApex, *pRightPoint ) || TriangleArea2D( *pApex, *pLeftPoint, *pRight ) > 0 )
             {
-                GoalIndex = rPath.size();
-                break;
+                pRightPoint = pRight;
+                RightIndex  = i;
             }
-
-            tgBool        LinesIntersected = false;
-            const tgCV3D* pStartPoint      = &rPath[StartIndex]->Center;
-            const tgCV3D* pGoalPoint       = &rPath[GoalIndex]->Center;
-            tgCV3D        StartToGoal      = *pGoalPoint - *pStartPoint;
-            tgCLine2D     StartToGoalLine( tgCV2D( pStartPoint->x, pStartPoint->z ), tgCV2D( pGoalPoint->x, pGoalPoint->z ) );
-
-            for( const tgCLine3D& rNavMeshEdge : rNavMeshEdges )
+            else
             {
-                tgCLine2D Edge( tgCV2D( rNavMeshEdge.GetStart().x, rNavMeshEdge.GetStart().z ), tgCV2D( rNavMeshEdge.GetEnd().x, rNavMeshEdge.GetEnd().z ) );
+                pApex = pLeftPoint;
+                if( !( m_FunneledPath.back() == *pApex ) )
+                    m_FunneledPath.push_back( *pApex );
 
-                if( Edge.Intersect( StartToGoalLine ) )
-                {
-                    LinesIntersected = true;
-                    break;
-                }
+                pRightPoint = pApex;
+                RightIndex  = LeftIndex;
+                i           = LeftIndex;
+                continue;
             }
+        }
 
-            if( IndexChangeAmount > 1 )
-                IndexChangeAmount /= 2;
-
-            if( LinesIntersected )
-                GoalIndex -= IndexChangeAmount;
-            else
+        // Tighten the left side, crossing over the right side turns the right point into a corner
+        if( TriangleArea2D( *pApex, *pLeftPoint, *pLeft ) >= 0 )
+        {
+            if( IsSamePoint2D( *pApex, *pLeftPoint ) || TriangleArea2D( *pApex, *pRightPoint, *pLeft ) < 0 )
             {
-                if( IndexChangeAmount <= 2 )
-                {
-                    StartIndex = GoalIndex;
-                    m_FunneledPath.push_back( pGoalPoint );
-                    break;
-                }
-
-                GoalIndex += IndexChangeAmount;
+                pLeftPoint = pLeft;
+                LeftIndex  = i;
             }
-        } while( true );
+            else
+            {
+                pApex = pRightPoint;
+                if( !( m_FunneledPath.back() == *pApex ) )
+                    m_FunneledPath.push_back( *pApex );
 
-        NodesLeftToFunnel = rPath.size() - GoalIndex;
+                pLeftPoint = pApex;
+                LeftIndex  = RightIndex;
+                i          = RightIndex;
+                continue;
+            }
+        }
     }
 
-    m_FunneledPath.push_back( &m_pGoalNode->Center );
+    if( !( m_FunneledPath.back() == *pGoalPoint ) || m_FunneledPath.size() == 1 )
+        m_FunneledPath.push_back( *pGoalPoint );
+}
+
+void CSolver::PrepareSearch( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    m_SearchNodes.resize( m_pNavMesh->GetNumTiles() );
+
+    for( tgUInt32 TileIndex = 0; TileIndex < m_pNavMesh->GetNumTiles(); ++TileIndex )
+    {
+        const CNavMeshTile* pTile = m_pNavMesh->GetTile( TileIndex );
+        m_SearchNodes[TileIndex].resize( pTile ? pTile->GetNumNodes() : 0, SSearchNode{ CNavMesh::INVALID_NODE, 0, 0 } );
+    }
 }
 
 void CSolver::Clear( void )
@@ -164,11 +248,25 @@ void CSolver::Clear( void )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    std::vector<SNavMeshNode>& rNodes = m_pNavMesh->GetNodes();
-    for( SNavMeshNode& rNode : rNodes )
+    // Bumping the generation invalidates every node at once, only a wrap around needs the full reset
+    if( ++m_SearchGeneration == 0 )
     {
-        rNode.pParentNode = nullptr;
-        rNode.IsClosed    = false;
-        rNode.IsVisited   = false;
+        for( std::vector<SSearchNode>& rTileSearchNodes : m_SearchNodes )
+        {
+            for( SSearchNode& rSearchNode : rTileSearchNodes )
+            {
+                rSearchNode.VisitedGeneration = 0;
+                rSearchNode.ClosedGeneration  = 0;
+            }
+        }
+
+        m_SearchGeneration = 1;
     }
 }
+
+void CSolver::SetVisited( const tgUInt32 Node, const tgUInt32 ParentNode )
+{
+    SSearchNode& rSearchNode      = GetSearchNode( Node );
+    rSearchNode.ParentNode        = ParentNode;
+    rSearchNode.VisitedGeneration = m_SearchGeneration;
+}
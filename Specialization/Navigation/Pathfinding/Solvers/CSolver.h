@@ -1,7 +1,7 @@
 #pragma once
 
-#include "Navigation/SNavMeshNode.h"
 #include "Navigation/CNavMesh.h"
+#include "../SSearchNode.h"
 
 #include <tgCV3D.h>
 
@@ -19,29 +19,47 @@ public:
         ,PATH_NOT_FOUND
     };
 
-    CSolver( CNavMesh* pNavMesh, tgCMutex* pMutex );
+    CSolver( const CNavMesh* pNavMesh );
     virtual ~CSolver( void ) = default;
 
-    EResult FindPath( SNavMeshNode* pStartNode, SNavMeshNode* pGoalNode, const tgBool& rStopping = false );
+    EResult FindPath( const tgUInt32 StartNode, const tgUInt32 GoalNode, const tgBool& rStopping = false );
 
-    std::vector<const tgCV3D*>& GetFunneledPath( void ) { return m_FunneledPath; }
+    std::vector<tgCV3D>& GetFunneledPath( void ) { return m_FunneledPath; }
+
+    // Nodes whose neighbours were searched, summed over every FindPath since the solver was created
+    tgUInt64 GetNumExpandedNodes( void ) const { return m_NumExpandedNodes; }
 
 protected:
     virtual tgBool Search( void ) = 0;
 
-    tgBool GetPath( std::vector<SNavMeshNode*>& rPath, const tgBool& rStopping );
+    tgBool GetPath( std::vector<tgUInt32>& rPath, const tgBool& rStopping );
 
-    void FunnelPath( const std::vector<SNavMeshNode*>& rPath );
+    void FunnelPath( const std::vector<tgUInt32>& rPath );
 
+    virtual void PrepareSearch( void );
     virtual void Clear( void );
 
-    std::vector<const tgCV3D*> m_FunneledPath;
+    SSearchNode&       GetSearchNode( const tgUInt32 Node ) { return m_SearchNodes[CNavMesh::GetTileIndex( Node )][CNavMesh::GetLocalNode( Node )]; }
+    const SSearchNode& GetSearchNode( const tgUInt32 Node ) const { return m_SearchNodes[CNavMesh::GetTileIndex( Node )][CNavMesh::GetLocalNode( Node )]; }
+
+    tgBool IsVisited( const tgUInt32 Node ) const { return GetSearchNode( Node ).VisitedGeneration == m_SearchGeneration; }
+    tgBool IsClosed( const tgUInt32 Node ) const { return GetSearchNode( Node ).ClosedGeneration == m_SearchGeneration; }
+    void   SetVisited( const tgUInt32 Node, const tgUInt32 ParentNode );
+    void   SetClosed( const tgUInt32 Node ) { GetSearchNode( Node ).ClosedGeneration = m_SearchGeneration; }
+
+    // The path is copied out of the tiles since they can be unloaded while it is still followed, the portal points only live through one funnel pass
+    std::vector<tgCV3D>        m_FunneledPath;
+    std::vector<const tgCV3D*> m_LeftPortalPoints;
+    std::vector<const tgCV3D*> m_RightPortalPoints;
 
-    CNavMesh* m_pNavMesh;
+    const CNavMesh* m_pNavMesh;
 
-    SNavMeshNode* m_pStartNode;
-    SNavMeshNode* m_pGoalNode;
-    SNavMeshNode* m_pCurrentNode;
+    // Indexed by tile and then by tile-local node, tiles can be streamed in between searches so it is resized before each one
+    std::vector<std::vector<SSearchNode>> m_SearchNodes;
+    tgUInt32                              m_SearchGeneration;
+    tgUInt64                              m_NumExpandedNodes;
 
-    tgCMutex* m_pMutex;
+    tgUInt32 m_StartNode;
+    tgUInt32 m_GoalNode;
+    tgUInt32 m_CurrentNode;
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CMappedFile.h"
+
+#include <tgMemoryDisable.h>
+#include <cstring>
+#include <vector>
+#include <tgMemoryEnable.h>
+
+// Cache files are a header, a table of sections and the 16 byte aligned section data, all read in place through a mapping
+static const tgUInt32 CacheTileMagic   = 0x4E41564D; // "NAVM"
+static const tgUInt32 CacheLayoutMagic = 0x4E41564C; // "NAVL"
+static const tgUInt32 CacheVersion     = 8;
+
+struct SCacheHeader
+{
+    tgUInt32 Magic;
+    tgUInt32 Version;
+    tgUInt64 SourceHash;
+    tgUInt32 NumSections;
+    tgUInt32 MaxPolygonVertices;
+};
+
+struct SCacheSection
+{
+    tgUInt32 Stride;
+    tgUInt32 Count;
+    tgUInt64 Offset;
+};
+
+template<typename T>
+const T* GetCacheSection( const CMappedFile& rFile, const SCacheSection& rSection, const tgSize ExpectedCount )
+{
+    if( rSection.Stride != sizeof( T ) || rSection.Count != ExpectedCount )
+        return nullptr;
+
+    if( rSection.Offset % alignof( T ) != 0 || rSection.Offset + static_cast<tgUInt64>( rSection.Stride ) * rSection.Count > rFile.GetSize() )
+        return nullptr;
+
+    return reinterpret_cast<const T*>( rFile.GetData() + rSection.Offset );
+}
+
+template<typename T>
+void SetCacheSection( SCacheSection& rSection, const std::vector<T>& rData, tgUInt64& rOffset )
+{
+    rSection.Stride = sizeof( T );
+    rSection.Count  = static_cast<tgUInt32>( rData.size() );
+    rSection.Offset = rOffset;
+
+    rOffset += static_cast<tgUInt64>( rSection.Stride ) * rSection.Count;
+    rOffset  = ( rOffset + 15 ) & ~static_cast<tgUInt64>( 15 );
+}
+
+template<typename T>
+void CopyCacheSection( std::vector<tgUInt8>& rBuffer, const SCacheSection& rSection, const std::vector<T>& rData )
+{
+    if( !rData.empty() )
+        memcpy( rBuffer.data() + rSection.Offset, rData.data(), rData.size() * sizeof( T ) );
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <tgCV3D.h>
+
+#include <tgMemoryDisable.h>
+#include <vector>
+#include <tgMemoryEnable.h>
+
+struct SNavMeshContour
+{
+    SNavMeshContour( void )
+        : Points()
+        , IsClosed( false )
+    {}
+
+    std::vector<tgCV3D> Points;
+
+    tgBool IsClosed;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+// Slot i holds the node across polygon edge i, boundary edges and unused slots hold CNavMesh::INVALID_NODE
+struct SNavMeshNeighbours
+{
+    static constexpr tgUInt32 MAX_NEIGHBOURS = 6;
+
+    tgUInt32 Nodes[MAX_NEIGHBOURS];
+};
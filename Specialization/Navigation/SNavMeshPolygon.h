@@ -0,0 +1,8 @@
+#pragma once
+
+// A convex polygon in the navmesh index array, wound the same way as the source triangles
+struct SNavMeshPolygon
+{
+    tgUInt32 FirstIndex;
+    tgUInt32 NumVertices;
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+// The edge shared with the neighbour in the same slot, in the winding order of the owning node
+struct SNavMeshPortal
+{
+    tgCV3D Start;
+    tgCV3D End;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+// A vertex as 16 bit steps from the quantization origin of its tile
+struct SNavMeshQuantizedVertex
+{
+    tgUInt16 X;
+    tgUInt16 Y;
+    tgUInt16 Z;
+};
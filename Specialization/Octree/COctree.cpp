@@ -8,19 +8,92 @@
 #include <tgCV3D.h>
 #include <tgCDebugManager.h>
 #include <tgCProfiling.h>
+#include <tgCMutex.h>
+#include <tgCThread.h>
 #include <tgMemoryDisable.h>
 #include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <tgCLine3D.h>
 #include <tgCSphere.h>
 #include <tgMemoryEnable.h>
 
-tgBool SortAscendingId( const IOctreeObject* pLIn, const IOctreeObject* pRIn ) { return pLIn->GetId() < pRIn->GetId(); }
+// Constants bound to references need a definition of their own before C++17
+constexpr tgUInt32 SOctreeNode::INVALID_INDEX;
+constexpr tgUInt32 IOctreeObject::INVALID_SLOT;
+constexpr tgUInt32 COctree::INVALID_LEAF;
+constexpr tgUInt32 COctree::MAX_DEPTH_LIMIT;
+constexpr tgUInt32 COctree::PARALLEL_BUILD_DEPTH;
+constexpr tgUInt32 COctree::PARALLEL_UPDATE_MIN_OBJECTS;
+constexpr tgUInt32 COctree::UPDATE_BATCH_SIZE;
 
-COctree::COctree( const tgUInt32 DepthLimit )
-    : m_DepthLimit( DepthLimit )
-    , m_RootNode()
+// The update workers sleep on WorkReady until objects are left to take and are woken for good by IsStopping
+struct COctree::SUpdateParams
+{
+    COctree*                           pOctree;
+    const std::vector<IOctreeObject*>* pObjects;
+
+    std::mutex              Mutex;
+    std::condition_variable WorkReady;
+    std::condition_variable WorkDone;
+    tgUInt32                NumObjects;
+    tgUInt32                NextObject;
+    tgUInt32                NumFinishedObjects;
+    tgBool                  IsStopping;
+};
+
+// Moves the low 21 bits of Value to every third bit
+tgUInt64 SpreadBits( tgUInt64 Value )
+{
+    Value &= 0x1FFFFF;
+    Value  = ( Value | Value << 32 ) & 0x1F00000000FFFF;
+    Value  = ( Value | Value << 16 ) & 0x1F0000FF0000FF;
+    Value  = ( Value | Value << 8 ) & 0x100F00F00F00F00F;
+    Value  = ( Value | Value << 4 ) & 0x10C30C30C30C30C3;
+    Value  = ( Value | Value << 2 ) & 0x1249249249249249;
+
+    return Value;
+}
+
+tgUInt32 CompactBits( tgUInt64 Value )
+{
+    Value &= 0x1249249249249249;
+    Value  = ( Value ^ ( Value >> 2 ) ) & 0x10C30C30C30C30C3;
+    Value  = ( Value ^ ( Value >> 4 ) ) & 0x100F00F00F00F00F;
+    Value  = ( Value ^ ( Value >> 8 ) ) & 0x1F0000FF0000FF;
+    Value  = ( Value ^ ( Value >> 16 ) ) & 0x1F00000000FFFF;
+    Value  = ( Value ^ ( Value >> 32 ) ) & 0x1FFFFF;
+
+    return static_cast<tgUInt32>( Value );
+}
+
+// Zero for points inside the box
+tgFloat GetDistanceSquared( const tgCAABox3D& rBox, const tgCV3D& rPoint )
+{
+    const tgCV3D Closest( tgMathClamp( rBox.GetMin().x, rPoint.x, rBox.GetMax().x ), tgMathClamp( rBox.GetMin().y, rPoint.y, rBox.GetMax().y ), tgMathClamp( rBox.GetMin().z, rPoint.z, rBox.GetMax().z ) );
+
+    return ( rPoint - Closest ).DotProduct();
+}
+
+COctree::COctree( const tgUInt32 DepthLimit, const tgBool ParallelBuild )
+    : m_DepthLimit( std::min( DepthLimit, MAX_DEPTH_LIMIT ) )
     , m_Offsets{ tgCV3D( -1 ) ,tgCV3D( -1, -1, 1 ) ,tgCV3D( -1, 1, -1 ) ,tgCV3D( -1, 1, 1 ) ,tgCV3D( 1, -1, -1 ) ,tgCV3D( 1, -1, 1 ) ,tgCV3D( 1, 1, -1 ) ,tgCV3D( 1 ) }
-    , m_DeepestNodes()
+    , m_Leaves()
+    , m_LeafIndices()
+    , m_OccupiedLeaves()
+    , m_UpdateLeafIndices()
+    , m_UpdateMoves()
+    , m_UpdateLeafStarts()
+    , m_pUpdateParams( nullptr )
+    , m_UpdateThreads()
+    , m_Box( 0 )
+    , m_LeafDepth( m_DepthLimit > 0 ? m_DepthLimit - 1 : 0 )
+    , m_NumCells( 1U << m_LeafDepth )
+    , m_CellsPerUnit( 0 )
+    , m_MaxObjectRadius( 0 )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
@@ -28,34 +101,84 @@ COctree::COctree( const tgUInt32 DepthLimit )
 
     CNavMesh* pNavMesh = CLevel::GetInstance().GetNavMesh();
 
-    m_RootNode.Box.Set( pNavMesh->GetNode( 0 )->Center );
-    for( SNavMeshNode& rNavMeshNode : pNavMesh->GetNodes() )
+    std::vector<tgCV3D> Points;
+    SOctreeNode         RootNode;
+
+    tgBool HasBox = false;
+    for( tgUInt32 TileIndex = 0; TileIndex < pNavMesh->GetNumTiles(); ++TileIndex )
     {
-        for( int i = 0; i < 3; ++i )
-            m_RootNode.Box.AddPoint( rNavMeshNode.Triangle.GetVertex( i ) );
+        const CNavMeshTile* pTile = pNavMesh->GetTile( TileIndex );
+        if( !pTile || !pTile->GetNumNodes() )
+            continue;
+
+        for( tgUInt32 NavMeshNode = 0; NavMeshNode < pTile->GetNumNodes(); ++NavMeshNode )
+            Points.push_back( pTile->GetCenter( NavMeshNode ) );
+
+        if( HasBox )
+        {
+            RootNode.Box.AddPoint( pTile->GetBounds().GetMin() );
+            RootNode.Box.AddPoint( pTile->GetBounds().GetMax() );
+        }
+        else
+        {
+            RootNode.Box.Set( pTile->GetBounds().GetMin(), pTile->GetBounds().GetMax() );
+            HasBox = true;
+        }
     }
 
-    const tgCV3D& NavBoxMin = m_RootNode.Box.GetMin();
-    const tgCV3D& NavBoxMax = m_RootNode.Box.GetMax();
-    m_RootNode.Center       = ( NavBoxMax - NavBoxMin ) / 2 + NavBoxMin;
+    const tgCV3D& NavBoxMin = RootNode.Box.GetMin();
+    const tgCV3D& NavBoxMax = RootNode.Box.GetMax();
+    RootNode.Center         = ( NavBoxMax - NavBoxMin ) / 2 + NavBoxMin;
+
+    tgFloat CubeExtent = tgMathAbs( NavBoxMin.x - RootNode.Center.x );
+    CubeExtent         = tgMathAbs( NavBoxMin.y - RootNode.Center.y ) > CubeExtent ? tgMathAbs( NavBoxMin.y - RootNode.Center.y ) : CubeExtent;
+    CubeExtent         = tgMathAbs( NavBoxMin.z - RootNode.Center.z ) > CubeExtent ? tgMathAbs( NavBoxMin.z - RootNode.Center.z ) : CubeExtent;
+    CubeExtent         = NavBoxMax.x - RootNode.Center.x > CubeExtent ? NavBoxMax.x - RootNode.Center.x : CubeExtent;
+    CubeExtent         = NavBoxMax.y - RootNode.Center.y > CubeExtent ? NavBoxMax.y - RootNode.Center.y : CubeExtent;
+    CubeExtent         = NavBoxMax.z - RootNode.Center.z > CubeExtent ? NavBoxMax.z - RootNode.Center.z : CubeExtent;
 
-    tgFloat CubeExtent = tgMathAbs( NavBoxMin.x - m_RootNode.Center.x );
-    CubeExtent         = tgMathAbs( NavBoxMin.y - m_RootNode.Center.y ) > CubeExtent ? tgMathAbs( NavBoxMin.y - m_RootNode.Center.y ) : CubeExtent;
-    CubeExtent         = tgMathAbs( NavBoxMin.z - m_RootNode.Center.z ) > CubeExtent ? tgMathAbs( NavBoxMin.z - m_RootNode.Center.z ) : CubeExtent;
-    CubeExtent         = NavBoxMax.x - m_RootNode.Center.x > CubeExtent ? NavBoxMax.x - m_RootNode.Center.x : CubeExtent;
-    CubeExtent         = NavBoxMax.y - m_RootNode.Center.y > CubeExtent ? NavBoxMax.y - m_RootNode.Center.y : CubeExtent;
-    CubeExtent         = NavBoxMax.z - m_RootNode.Center.z > CubeExtent ? NavBoxMax.z - m_RootNode.Center.z : CubeExtent;
+    RootNode.Box.Set( RootNode.Center - CubeExtent, RootNode.Center + CubeExtent );
+    RootNode.DepthIndex   = 0;
+    RootNode.LocationCode = 1;
 
-    m_RootNode.Box.Set( m_RootNode.Center - CubeExtent, m_RootNode.Center + CubeExtent );
-    m_RootNode.pParentNode = nullptr;
-    m_RootNode.OffsetIndex = -1;
-    m_RootNode.DepthIndex  = 0;
+    m_Box          = RootNode.Box;
+    m_CellsPerUnit = CubeExtent > 0 ? m_NumCells / ( CubeExtent * 2 ) : 0;
+
+    if( ParallelBuild )
+        CreateOctreeParallel( RootNode, Points );
+    else
+        CreateOctree( RootNode, Points, m_Leaves, nullptr );
+
+    m_LeafIndices.reserve( m_Leaves.size() );
+    for( tgUInt32 LeafIndex = 0; LeafIndex < m_Leaves.size(); ++LeafIndex )
+        m_LeafIndices.emplace( m_Leaves[LeafIndex].LocationCode, LeafIndex );
 
-    CreateOctree();
-    FindDeepestNodes( m_DeepestNodes );
     GetNeighbours();
 }
 
+COctree::~COctree( void )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    if( !m_pUpdateParams )
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock( m_pUpdateParams->Mutex );
+        m_pUpdateParams->IsStopping = true;
+    }
+    m_pUpdateParams->WorkReady.notify_all();
+
+    for( tgCThread* pThread : m_UpdateThreads )
+        delete pThread;
+    m_UpdateThreads.clear();
+
+    delete m_pUpdateParams;
+    m_pUpdateParams = nullptr;
+}
+
 void COctree::UpdateObject( IOctreeObject* pObject )
 {
 #if !defined( FINAL )
@@ -65,29 +188,335 @@ void COctree::UpdateObject( IOctreeObject* pObject )
     if( !pObject )
         return;
 
-    SOctreeNode* pCurrentNode = pObject->GetCurrentNode();
+    MoveObject( pObject, FindObjectLeaf( pObject ) );
+}
+
+void COctree::UpdateObjects( const std::vector<IOctreeObject*>& rObjects )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    m_UpdateLeafIndices.resize( rObjects.size() );
+
+    if( rObjects.size() < PARALLEL_UPDATE_MIN_OBJECTS || std::thread::hardware_concurrency() <= 1 )
+    {
+        FindObjectLeaves( rObjects, 0, rObjects.size() );
+    }
+    else
+    {
+        StartUpdateThreads();
+
+        {
+            std::lock_guard<std::mutex> Lock( m_pUpdateParams->Mutex );
+            m_pUpdateParams->pObjects           = &rObjects;
+            m_pUpdateParams->NumObjects         = static_cast<tgUInt32>( rObjects.size() );
+            m_pUpdateParams->NextObject         = 0;
+            m_pUpdateParams->NumFinishedObjects = 0;
+        }
+        m_pUpdateParams->WorkReady.notify_all();
+
+        // This thread takes batches as well and then sleeps until the batches still running on the workers are done
+        FindObjectLeaves( m_pUpdateParams );
+
+        SUpdateParams*               pParams = m_pUpdateParams;
+        std::unique_lock<std::mutex> Lock( pParams->Mutex );
+        pParams->WorkDone.wait( Lock, [pParams]() { return pParams->NumFinishedObjects == pParams->NumObjects; } );
+        pParams->pObjects = nullptr;
+    }
+
+    // Membership only changes on this thread, every moved object leaves its old leaf before the new leaves are filled one leaf at a time
+    m_UpdateLeafStarts.assign( m_Leaves.size() + 1, 0 );
+
+    tgUInt32 NumMoves = 0;
+    for( tgUInt32 i = 0; i < rObjects.size(); ++i )
+    {
+        IOctreeObject* pObject = rObjects[i];
+        if( GetObjectLeaf( pObject ) == m_UpdateLeafIndices[i] )
+            continue;
+
+        if( pObject->GetCurrentNode() )
+            RemoveObject( pObject );
+
+        if( m_UpdateLeafIndices[i] != INVALID_LEAF )
+        {
+            ++m_UpdateLeafStarts[m_UpdateLeafIndices[i] + 1];
+            ++NumMoves;
+        }
+    }
+
+    if( !NumMoves )
+        return;
+
+    // Counting sort the moves by their new leaf
+    for( tgSize LeafIndex = 1; LeafIndex < m_UpdateLeafStarts.size(); ++LeafIndex )
+        m_UpdateLeafStarts[LeafIndex] += m_UpdateLeafStarts[LeafIndex - 1];
+
+    m_UpdateMoves.resize( NumMoves );
+    for( tgUInt32 i = 0; i < rObjects.size(); ++i )
+    {
+        const tgUInt32 LeafIndex = m_UpdateLeafIndices[i];
+        if( LeafIndex != INVALID_LEAF && !rObjects[i]->GetCurrentNode() )
+            m_UpdateMoves[m_UpdateLeafStarts[LeafIndex]++] = i;
+    }
+
+    for( const tgUInt32 ObjectIndex : m_UpdateMoves )
+        AddObject( &m_Leaves[m_UpdateLeafIndices[ObjectIndex]], rObjects[ObjectIndex] );
+}
+
+tgBool COctree::Raycast( const tgCLine3D& rLine, const tgFloat MaxDistance, std::vector<SOctreeRaycastHit>& rHits, const tgBool StopAtFirstHit, RaycastFilter pFilter, void* pUserData ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    rHits.clear();
+
+    const tgCV3D  Start      = rLine.GetStart();
+    const tgCV3D  LineDelta  = rLine.GetEnd() - Start;
+    const tgFloat LineLength = LineDelta.Length();
+
+    if( m_Leaves.empty() || LineLength <= 0 || MaxDistance <= 0 )
+        return false;
+
+    const tgCV3D  Direction = LineDelta / LineLength;
+    const tgFloat Length    = std::min( LineLength, MaxDistance );
+
+    // Positions along the ray are in world units, positions in the grid are in cells from the min corner of the root cube
+    const tgCV3D  GridStart = ( Start - m_Box.GetMin() ) * m_CellsPerUnit;
+    const tgFloat Origin[3] = { GridStart.x, GridStart.y, GridStart.z };
+    const tgFloat Slope[3]  = { Direction.x * m_CellsPerUnit, Direction.y * m_CellsPerUnit, Direction.z * m_CellsPerUnit };
+    const tgFloat NumCells  = static_cast<tgFloat>( m_NumCells );
+
+    tgFloat Enter = 0;
+    tgFloat Exit  = Length;
+
+    for( tgUInt32 Axis = 0; Axis < 3; ++Axis )
+    {
+        if( Slope[Axis] == 0 )
+        {
+            if( Origin[Axis] < 0 || Origin[Axis] > NumCells )
+                return false;
+
+            continue;
+        }
+
+        tgFloat AxisEnter = -Origin[Axis] / Slope[Axis];
+        tgFloat AxisExit  = ( NumCells - Origin[Axis] ) / Slope[Axis];
+        if( AxisEnter > AxisExit )
+            std::swap( AxisEnter, AxisExit );
+
+        Enter = std::max( Enter, AxisEnter );
+        Exit  = std::min( Exit, AxisExit );
+    }
+
+    if( Enter > Exit )
+        return false;
+
+    // Set up the walk through the cells, every step crosses the closest cell face along the ray
+    tgSInt32 Cell[3];
+    tgSInt32 Step[3];
+    tgFloat  NextFace[3];
+    tgFloat  FaceDistance[3];
+
+    for( tgUInt32 Axis = 0; Axis < 3; ++Axis )
+    {
+        const tgFloat Position = Origin[Axis] + Slope[Axis] * Enter;
+        Cell[Axis]             = tgMathClamp( 0, static_cast<tgSInt32>( std::floor( Position ) ), static_cast<tgSInt32>( m_NumCells ) - 1 );
+
+        if( Slope[Axis] > 0 )
+        {
+            Step[Axis]         = 1;
+            NextFace[Axis]     = Enter + ( Cell[Axis] + 1 - Position ) / Slope[Axis];
+            FaceDistance[Axis] = 1 / Slope[Axis];
+        }
+        else if( Slope[Axis] < 0 )
+        {
+            Step[Axis]         = -1;
+            NextFace[Axis]     = Enter + ( Cell[Axis] - Position ) / Slope[Axis];
+            FaceDistance[Axis] = -1 / Slope[Axis];
+        }
+        else
+        {
+            Step[Axis]         = 0;
+            NextFace[Axis]     = TG_FLOAT_MAX;
+            FaceDistance[Axis] = TG_FLOAT_MAX;
+        }
+    }
+
+    // The centers of objects in later leaves project at most one cell's extent before the leaf's entry, and their spheres reach back by their radius
+    const tgFloat HitSlack = ( std::abs( Direction.x ) + std::abs( Direction.y ) + std::abs( Direction.z ) ) / m_CellsPerUnit + m_MaxObjectRadius;
+
+    tgFloat CellEnter  = Enter;
+    tgFloat ClosestHit = TG_FLOAT_MAX;
+
+    while( CellEnter <= Exit )
+    {
+        if( StopAtFirstHit && CellEnter - HitSlack > ClosestHit )
+            break;
+
+        const auto it = m_LeafIndices.find( GetLocationCode( static_cast<tgUInt32>( Cell[0] ), static_cast<tgUInt32>( Cell[1] ), static_cast<tgUInt32>( Cell[2] ), m_LeafDepth ) );
+        if( it != m_LeafIndices.end() )
+        {
+            for( IOctreeObject* pObject : m_Leaves[it->second].Objects )
+            {
+                tgFloat Distance;
+                if( !GetRayHitDistance( pObject, Start, Direction, Length, Distance ) )
+                    continue;
+
+                if( pFilter && !pFilter( pObject, pUserData ) )
+                    continue;
+
+                rHits.push_back( SOctreeRaycastHit{ pObject, Distance } );
+                ClosestHit = std::min( ClosestHit, Distance );
+            }
+        }
+
+        tgUInt32 Axis = NextFace[0] < NextFace[1] ? 0 : 1;
+        Axis          = NextFace[2] < NextFace[Axis] ? 2 : Axis;
+
+        CellEnter       = NextFace[Axis];
+        Cell[Axis]     += Step[Axis];
+        NextFace[Axis] += FaceDistance[Axis];
+
+        if( Cell[Axis] < 0 || Cell[Axis] >= static_cast<tgSInt32>( m_NumCells ) )
+            break;
+    }
+
+    std::sort( rHits.begin(), rHits.end(), []( const SOctreeRaycastHit& rLeft, const SOctreeRaycastHit& rRight ) { return rLeft.Distance < rRight.Distance; } );
+
+    if( StopAtFirstHit && rHits.size() > 1 )
+        rHits.resize( 1 );
+
+    return !rHits.empty();
+}
+
+tgBool COctree::QuerySphere( const tgCSphere& rSphere, std::vector<IOctreeObject*>& rObjects ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const tgCAABox3D SphereBox( rSphere.GetPos() - rSphere.GetRadius(), rSphere.GetPos() + rSphere.GetRadius() );
+    QueryLeaves( SphereBox, &rSphere, rObjects );
+
+    return !rObjects.empty();
+}
+
+tgBool COctree::QueryAABB( const tgCAABox3D& rBox, std::vector<IOctreeObject*>& rObjects ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    QueryLeaves( rBox, nullptr, rObjects );
+
+    return !rObjects.empty();
+}
+
+tgBool COctree::QueryKNearest( const tgCV3D& rPoint, const tgUInt32 K, std::vector<IOctreeObject*>& rObjects, const tgFloat MaxDistance ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    rObjects.clear();
+
+    if( m_OccupiedLeaves.empty() || K == 0 || MaxDistance < 0 )
+        return false;
+
+    // rObjects is a max heap on distance while searching, so the farthest of the K closest so far is on top
+    const auto IsCloser = [ &rPoint ]( IOctreeObject* pLeft, IOctreeObject* pRight ) { return ( *pLeft->GetPosition() - rPoint ).DotProduct() < ( *pRight->GetPosition() - rPoint ).DotProduct(); };
+
+    tgFloat MaxDistanceSquared = MaxDistance < TG_FLOAT_MAX ? MaxDistance * MaxDistance : TG_FLOAT_MAX;
+
+    const auto AddLeaf = [ & ]( const SOctreeNode& rNode )
+    {
+        if( rNode.Objects.empty() || GetDistanceSquared( rNode.Box, rPoint ) > MaxDistanceSquared )
+            return;
+
+        for( IOctreeObject* pObject : rNode.Objects )
+        {
+            const tgFloat DistanceSquared = ( *pObject->GetPosition() - rPoint ).DotProduct();
+            if( DistanceSquared > MaxDistanceSquared )
+                continue;
+
+            rObjects.push_back( pObject );
+            std::push_heap( rObjects.begin(), rObjects.end(), IsCloser );
+
+            if( rObjects.size() > K )
+            {
+                std::pop_heap( rObjects.begin(), rObjects.end(), IsCloser );
+                rObjects.pop_back();
+            }
+
+            if( rObjects.size() == K )
+                MaxDistanceSquared = ( *rObjects.front()->GetPosition() - rPoint ).DotProduct();
+        }
+    };
+
+    // Search shells of cells around the point's cell, every point in a cell r shells out is at least r - 1 cells away
+    const tgCV3D   GridPoint = ( rPoint - m_Box.GetMin() ) * m_CellsPerUnit;
+    const tgSInt32 LastCell  = static_cast<tgSInt32>( m_NumCells ) - 1;
+    const tgSInt32 Center[3] =
+    {
+        tgMathClamp( 0, static_cast<tgSInt32>( std::floor( GridPoint.x ) ), LastCell ),
+        tgMathClamp( 0, static_cast<tgSInt32>( std::floor( GridPoint.y ) ), LastCell ),
+        tgMathClamp( 0, static_cast<tgSInt32>( std::floor( GridPoint.z ) ), LastCell ),
+    };
 
-    if( pCurrentNode )
+    for( tgSInt32 Shell = 0; Shell <= LastCell; ++Shell )
     {
-        const tgFloat    BoxExtent = pObject->GetBoundingSphere()->GetRadius();
-        const tgCAABox3D ObjectBox( *pObject->GetPosition() - BoxExtent, *pObject->GetPosition() + BoxExtent );
+        const tgFloat ShellDistance = ( Shell - 1 ) / m_CellsPerUnit;
+        if( Shell > 1 && ShellDistance * ShellDistance > MaxDistanceSquared )
+            break;
 
-        if( !pCurrentNode->Box.PointInside( *pObject->GetPosition() ) )
+        // Once a shell has more cells than there are occupied leaves, the remaining leaves are cheaper to visit directly
+        const tgUInt64 ShellSize = static_cast<tgUInt64>( 2 * Shell + 1 ) * ( 2 * Shell + 1 ) * ( 2 * Shell + 1 ) - ( Shell > 0 ? static_cast<tgUInt64>( 2 * Shell - 1 ) * ( 2 * Shell - 1 ) * ( 2 * Shell - 1 ) : 0 );
+        if( ShellSize > m_OccupiedLeaves.size() )
         {
-            const auto it = std::lower_bound( pCurrentNode->Objects.begin(), pCurrentNode->Objects.end(), pObject, SortAscendingId );
-            if( it._Ptr && *it._Ptr == pObject && !pCurrentNode->Objects.empty() )
+            for( const SOctreeNode* pNode : m_OccupiedLeaves )
             {
-                pCurrentNode->Objects.erase( it );
-                pObject->SetCurrentNode( nullptr );
+                tgUInt32 Cell[3];
+                GetCell( pNode->LocationCode, m_LeafDepth, Cell[0], Cell[1], Cell[2] );
+
+                const tgSInt32 NodeShell = std::max( { std::abs( static_cast<tgSInt32>( Cell[0] ) - Center[0] ), std::abs( static_cast<tgSInt32>( Cell[1] ) - Center[1] ), std::abs( static_cast<tgSInt32>( Cell[2] ) - Center[2] ) } );
+                if( NodeShell >= Shell )
+                    AddLeaf( *pNode );
             }
 
-            Insert( pObject );
+            break;
         }
 
-        UpdateObjectNeighbourNodes( pObject, pCurrentNode );
+        const tgSInt32 MinX = std::max( Center[0] - Shell, 0 );
+        const tgSInt32 MaxX = std::min( Center[0] + Shell, LastCell );
+        const tgSInt32 MinY = std::max( Center[1] - Shell, 0 );
+        const tgSInt32 MaxY = std::min( Center[1] + Shell, LastCell );
+
+        for( tgSInt32 x = MinX; x <= MaxX; ++x )
+        {
+            for( tgSInt32 y = MinY; y <= MaxY; ++y )
+            {
+                // Inside the shell's x and y faces only the two z faces belong to the shell
+                const tgBool   IsOnFace = std::abs( x - Center[0] ) == Shell || std::abs( y - Center[1] ) == Shell;
+                const tgSInt32 ZStep    = IsOnFace ? 1 : std::max( 2 * Shell, 1 );
+
+                for( tgSInt32 z = Center[2] - Shell; z <= Center[2] + Shell; z += ZStep )
+                {
+                    if( z < 0 || z > LastCell )
+                        continue;
+
+                    const SOctreeNode* pNode = GetLeaf( static_cast<tgUInt32>( x ), static_cast<tgUInt32>( y ), static_cast<tgUInt32>( z ) );
+                    if( pNode )
+                        AddLeaf( *pNode );
+                }
+            }
+        }
     }
-    else
-        Insert( pObject );
+
+    std::sort_heap( rObjects.begin(), rObjects.end(), IsCloser );
+
+    return !rObjects.empty();
 }
 
 void COctree::Render( void )
@@ -96,10 +525,9 @@ void COctree::Render( void )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    tgCDebugManager&                rDebugManager = tgCDebugManager::GetInstance();
-    const std::vector<SOctreeNode*> Nodes         = GetNodesWithObjects();
+    tgCDebugManager& rDebugManager = tgCDebugManager::GetInstance();
 
-    for( const SOctreeNode* pNode : Nodes )
+    for( const SOctreeNode* pNode : m_OccupiedLeaves )
     {
         rDebugManager.AddLineAABox3D( pNode->Box, tgCColor::Green );
 
@@ -108,190 +536,527 @@ void COctree::Render( void )
     }
 }
 
-void COctree::Insert( IOctreeObject* pObject, SOctreeNode* pCurrentNode )
+void COctree::Insert( IOctreeObject* pObject )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    if( !pCurrentNode )
-    {
-        pCurrentNode = &m_RootNode;
+    MoveObject( pObject, GetLeafIndex( *pObject->GetPosition() ) );
+}
 
-        if( !pCurrentNode->Box.PointInside( *pObject->GetPosition() ) )
-            return;
-    }
+const SOctreeNode* COctree::GetNode( const tgCV3D& rPoint ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    const tgUInt32 LeafIndex = GetLeafIndex( rPoint );
 
-    if( pCurrentNode->ChildNodes.empty() )
+    return LeafIndex != INVALID_LEAF ? &m_Leaves[LeafIndex] : nullptr;
+}
+
+void COctree::CreateOctree( SOctreeNode& rCurrentNode, std::vector<tgCV3D>& rPoints, std::vector<SOctreeNode>& rLeaves, SBuildParams* pParams ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    // Children are visited in offset order, so the leaves come out sorted by location code
+    if( rCurrentNode.DepthIndex + 1 >= m_DepthLimit )
     {
-        const auto it = std::lower_bound( pCurrentNode->Objects.begin(), pCurrentNode->Objects.end(), pObject, SortAscendingId );
-        if( it._Ptr && *it._Ptr == pObject && !pCurrentNode->Objects.empty() )
-            return;
+        rLeaves.push_back( std::move( rCurrentNode ) );
+        return;
+    }
 
-        pObject->SetCurrentNode( pCurrentNode );
-        pCurrentNode->Objects.insert( it, pObject );
+    if( pParams && rCurrentNode.DepthIndex == PARALLEL_BUILD_DEPTH )
+    {
+        pParams->Nodes.push_back( std::move( rCurrentNode ) );
+        pParams->Points.push_back( std::move( rPoints ) );
         return;
     }
 
-    for( SOctreeNode& rNode : pCurrentNode->ChildNodes )
+    // Children only test the navmesh centers that touched their parent, so every level costs the same as one pass over the navmesh
+    tgCAABox3D          PointBox( 0, 0 );
+    std::vector<tgCV3D> ChildPoints;
+
+    for( tgUInt32 i = 0; i < 8; i++ )
     {
-        if( rNode.Box.PointInside( *pObject->GetPosition() ) )
-            Insert( pObject, &rNode );
+        SOctreeNode Node{};
+        CreateNode( Node, rCurrentNode, i );
+
+        ChildPoints.clear();
+        for( const tgCV3D& rPoint : rPoints )
+        {
+            PointBox.Set( rPoint - 1, rPoint + 1 );
+            if( Node.Box.Intersect( PointBox ) )
+                ChildPoints.push_back( rPoint );
+        }
+
+        if( !ChildPoints.empty() )
+            CreateOctree( Node, ChildPoints, rLeaves, pParams );
     }
 }
 
-std::vector<SOctreeNode*> COctree::GetNodesWithObjects( void )
+void COctree::CreateOctreeParallel( SOctreeNode& rRootNode, std::vector<tgCV3D>& rPoints )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    std::vector<SOctreeNode*> NodesWithObjects;
-    for( SOctreeNode* pNode : m_DeepestNodes )
+    tgCMutex     Mutex( "OctreeBuild" );
+    SBuildParams Params;
+    Params.pOctree            = this;
+    Params.pMutex             = &Mutex;
+    Params.NextNode           = 0;
+    Params.NumFinishedThreads = 0;
+
+    CreateOctree( rRootNode, rPoints, m_Leaves, &Params );
+    Params.Leaves.resize( Params.Nodes.size() );
+
+    const tgUInt32 NumThreads = std::min( static_cast<tgUInt32>( Params.Nodes.size() ), std::max( std::thread::hardware_concurrency(), 1U ) );
+    if( NumThreads <= 1 )
     {
-        if( !pNode->Objects.empty() )
-            NodesWithObjects.push_back( pNode );
+        for( tgSize i = 0; i < Params.Nodes.size(); ++i )
+            CreateOctree( Params.Nodes[i], Params.Points[i], Params.Leaves[i], nullptr );
+    }
+    else
+    {
+        std::vector<tgCThread*> Threads;
+        Threads.reserve( NumThreads );
+
+        for( tgUInt32 i = 0; i < NumThreads; ++i )
+            Threads.push_back( new tgCThread( "OctreeBuild", BuildNodesThread, tgCThread::PRIORITY_NORMAL, 65536U, &Params ) );
+
+        tgBool IsWorking = true;
+        while( IsWorking )
+        {
+            tgSleep( 1 );
+
+            tgCMutexScopeLock ScopeLock( Mutex );
+            IsWorking = Params.NumFinishedThreads < NumThreads;
+        }
+
+        for( tgCThread* pThread : Threads )
+            delete pThread;
     }
 
-    return std::move( NodesWithObjects );
+    // The subtrees were split off in location code order, so appending them keeps the leaves sorted
+    for( std::vector<SOctreeNode>& rLeaves : Params.Leaves )
+    {
+        for( SOctreeNode& rLeaf : rLeaves )
+            m_Leaves.push_back( std::move( rLeaf ) );
+    }
 }
 
-const SOctreeNode* COctree::GetNode( const tgCV3D& rPoint, SOctreeNode* pCurrentNode )
+void COctree::BuildNodesThread( tgCThread* pThread )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    if( !pCurrentNode )
-        pCurrentNode = &m_RootNode;
+    SBuildParams* pParams = static_cast<SBuildParams*>( pThread->GetUserData() );
 
-    for( SOctreeNode& rNode : pCurrentNode->ChildNodes )
+    while( true )
     {
-        if( rNode.Box.PointInside( rPoint ) )
-            return GetNode( rPoint, &rNode );
-    }
+        tgUInt32 NodeIndex = 0;
+        {
+            tgCMutexScopeLock ScopeLock( *pParams->pMutex );
+            if( pParams->NextNode >= pParams->Nodes.size() )
+            {
+                ++pParams->NumFinishedThreads;
+                return;
+            }
 
-    return nullptr;
+            NodeIndex = pParams->NextNode++;
+        }
+
+        pParams->pOctree->CreateOctree( pParams->Nodes[NodeIndex], pParams->Points[NodeIndex], pParams->Leaves[NodeIndex], nullptr );
+    }
 }
 
-void COctree::FindDeepestNodes( std::vector<SOctreeNode*>& rOutput, SOctreeNode* pCurrentNode )
+void COctree::CreateNode( SOctreeNode& rNode, const SOctreeNode& rParentNode, const tgUInt32 OffsetIndex ) const
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    if( !pCurrentNode )
-        pCurrentNode = &m_RootNode;
+    const tgCV3D& rMinPoint = rParentNode.Box.GetMin();
+    const tgCV3D& rMaxPoint = rParentNode.Box.GetMax();
+    const tgCV3D  BoxExtent = ( rMaxPoint - rMinPoint ) / 4;
 
-    for( SOctreeNode& rNode : pCurrentNode->ChildNodes )
-        FindDeepestNodes( rOutput, &rNode );
+    rNode.Center = rParentNode.Center + ( m_Offsets[OffsetIndex] * BoxExtent );
+    rNode.Box.Set( rNode.Center + -BoxExtent, rNode.Center + BoxExtent );
 
-    if( pCurrentNode->ChildNodes.empty() )
-        rOutput.push_back( pCurrentNode );
+    rNode.DepthIndex   = rParentNode.DepthIndex + 1;
+    rNode.LocationCode = ( rParentNode.LocationCode << 3 ) | OffsetIndex;
 }
 
-void COctree::CreateOctree( SOctreeNode* pCurrentNode )
+void COctree::GetNeighbours( void )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    if( !pCurrentNode )
-        pCurrentNode = &m_RootNode;
-
-    if( pCurrentNode->DepthIndex + 1 >= m_DepthLimit )
-        return;
+    const tgSInt64 NumCells = m_NumCells;
 
-    for( tgUInt32 i = 0; i < 8; i++ )
+    // Empty children are never created, so every leaf has the full depth and the touching leaves are the existing cells around it
+    for( SOctreeNode& rNode : m_Leaves )
     {
-        if( CreateNode( pCurrentNode, i ) )
-            CreateOctree( &pCurrentNode->ChildNodes.back() );
+        tgUInt32 CellX, CellY, CellZ;
+        GetCell( rNode.LocationCode, m_LeafDepth, CellX, CellY, CellZ );
+
+        for( tgSInt64 X = static_cast<tgSInt64>( CellX ) - 1; X <= CellX + 1; ++X )
+        {
+            for( tgSInt64 Y = static_cast<tgSInt64>( CellY ) - 1; Y <= CellY + 1; ++Y )
+            {
+                for( tgSInt64 Z = static_cast<tgSInt64>( CellZ ) - 1; Z <= CellZ + 1; ++Z )
+                {
+                    if( X < 0 || Y < 0 || Z < 0 || X >= NumCells || Y >= NumCells || Z >= NumCells )
+                        continue;
+
+                    if( X == CellX && Y == CellY && Z == CellZ )
+                        continue;
+
+                    const auto it = m_LeafIndices.find( GetLocationCode( static_cast<tgUInt32>( X ), static_cast<tgUInt32>( Y ), static_cast<tgUInt32>( Z ), m_LeafDepth ) );
+                    if( it != m_LeafIndices.end() )
+                        rNode.NeighbourNodes.push_back( &m_Leaves[it->second] );
+                }
+            }
+        }
     }
 }
 
-tgBool COctree::CreateNode( SOctreeNode* pParentNode, const tgUInt32 OffsetIndex )
+tgUInt32 COctree::GetLeafIndex( const tgCV3D& rPoint ) const
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    const tgCV3D& rMinPoint = pParentNode->Box.GetMin();
-    const tgCV3D& rMaxPoint = pParentNode->Box.GetMax();
-    const tgCV3D  BoxExtent = ( rMaxPoint - rMinPoint ) / 4;
+    if( m_Leaves.empty() || !m_Box.PointInside( rPoint ) )
+        return INVALID_LEAF;
 
-    SOctreeNode Node{};
-    Node.Center = pParentNode->Center + ( m_Offsets[OffsetIndex] * BoxExtent );
-    Node.Box.Set( Node.Center + -BoxExtent, Node.Center + BoxExtent );
+    // Points on the far side of the root cube belong to the last cell
+    const tgCV3D   Cell  = ( rPoint - m_Box.GetMin() ) * m_CellsPerUnit;
+    const tgUInt32 CellX = std::min( static_cast<tgUInt32>( Cell.x ), m_NumCells - 1 );
+    const tgUInt32 CellY = std::min( static_cast<tgUInt32>( Cell.y ), m_NumCells - 1 );
+    const tgUInt32 CellZ = std::min( static_cast<tgUInt32>( Cell.z ), m_NumCells - 1 );
 
-    Node.pParentNode = pParentNode;
-    Node.OffsetIndex = OffsetIndex;
-    Node.DepthIndex  = pParentNode->DepthIndex + 1;
+    const auto it = m_LeafIndices.find( GetLocationCode( CellX, CellY, CellZ, m_LeafDepth ) );
 
-    tgCAABox3D Box( 0, 0 );
+    return it != m_LeafIndices.end() ? it->second : INVALID_LEAF;
+}
+
+const SOctreeNode* COctree::GetLeaf( const tgUInt32 CellX, const tgUInt32 CellY, const tgUInt32 CellZ ) const
+{
+    const auto it = m_LeafIndices.find( GetLocationCode( CellX, CellY, CellZ, m_LeafDepth ) );
 
-    for( SNavMeshNode& rNavMeshNode : CLevel::GetInstance().GetNavMesh()->GetNodes() )
+    return it != m_LeafIndices.end() ? &m_Leaves[it->second] : nullptr;
+}
+
+tgBool COctree::GetCellRange( const tgCAABox3D& rBox, tgUInt32* pMinCell, tgUInt32* pMaxCell ) const
+{
+    if( m_Leaves.empty() || !m_Box.Intersect( rBox ) )
+        return false;
+
+    const tgCV3D  GridMin  = ( rBox.GetMin() - m_Box.GetMin() ) * m_CellsPerUnit;
+    const tgCV3D  GridMax  = ( rBox.GetMax() - m_Box.GetMin() ) * m_CellsPerUnit;
+    const tgFloat Min[3]   = { GridMin.x, GridMin.y, GridMin.z };
+    const tgFloat Max[3]   = { GridMax.x, GridMax.y, GridMax.z };
+    const tgFloat LastCell = static_cast<tgFloat>( m_NumCells - 1 );
+
+    // A box starting exactly on a cell face also touches the cell before it, which holds the objects kept on that face
+    for( tgUInt32 Axis = 0; Axis < 3; ++Axis )
     {
-        Box.Set( rNavMeshNode.Center - 1, rNavMeshNode.Center + 1 );
-        if( Node.Box.Intersect( Box ) )
-        {
-            pParentNode->ChildNodes.push_back( std::move( Node ) );
-            return true;
-        }
+        pMinCell[Axis] = static_cast<tgUInt32>( tgMathClamp( 0.0f, std::ceil( Min[Axis] ) - 1, LastCell ) );
+        pMaxCell[Axis] = static_cast<tgUInt32>( tgMathClamp( 0.0f, std::floor( Max[Axis] ), LastCell ) );
     }
 
-    return false;
+    return true;
 }
 
-void COctree::GetNeighbours( void )
+void COctree::QueryLeaves( const tgCAABox3D& rBox, const tgCSphere* pSphere, std::vector<IOctreeObject*>& rObjects ) const
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    for( tgUInt32 NodeIndex = 0; NodeIndex < m_DeepestNodes.size(); NodeIndex++ )
-    {
-        SOctreeNode* pNode = m_DeepestNodes[NodeIndex];
+    rObjects.clear();
 
-        for( tgUInt32 OtherNodeIndex = NodeIndex + 1; OtherNodeIndex < m_DeepestNodes.size(); OtherNodeIndex++ )
+    // Bounding spheres reach out of their leaves, so leaves this close to the box can hold overlapping objects
+    const tgCAABox3D LeafBox( rBox.GetMin() - m_MaxObjectRadius, rBox.GetMax() + m_MaxObjectRadius );
+
+    tgUInt32 MinCell[3];
+    tgUInt32 MaxCell[3];
+    if( m_OccupiedLeaves.empty() || !GetCellRange( LeafBox, MinCell, MaxCell ) )
+        return;
+
+    const auto AddObjects = [ & ]( const SOctreeNode& rNode )
+    {
+        for( IOctreeObject* pObject : rNode.Objects )
         {
-            SOctreeNode* pOtherNode = m_DeepestNodes[OtherNodeIndex];
+            const tgCSphere* pBoundingSphere = pObject->GetBoundingSphere();
+            tgBool           Overlaps;
 
-            tgBool AlreadyNeighbours = false;
-            for( const SOctreeNode* pNeighbourNode : pNode->NeighbourNodes )
+            if( pSphere && pBoundingSphere )
             {
-                if( pOtherNode == pNeighbourNode )
-                {
-                    AlreadyNeighbours = true;
-                    break;
-                }
+                const tgFloat Radius = pSphere->GetRadius() + pBoundingSphere->GetRadius();
+                Overlaps             = ( pBoundingSphere->GetPos() - pSphere->GetPos() ).DotProduct() <= Radius * Radius;
             }
+            else if( pSphere )
+                Overlaps = ( *pObject->GetPosition() - pSphere->GetPos() ).DotProduct() <= pSphere->GetRadius() * pSphere->GetRadius();
+            else if( pBoundingSphere )
+                Overlaps = GetDistanceSquared( rBox, pBoundingSphere->GetPos() ) <= pBoundingSphere->GetRadius() * pBoundingSphere->GetRadius();
+            else
+                Overlaps = rBox.PointInside( *pObject->GetPosition() );
 
-            if( AlreadyNeighbours )
-                continue;
+            if( Overlaps )
+                rObjects.push_back( pObject );
+        }
+    };
+
+    // Large boxes are cheaper to test against the occupied leaves than to look up cell by cell
+    const tgUInt64 NumCells = static_cast<tgUInt64>( MaxCell[0] - MinCell[0] + 1 ) * ( MaxCell[1] - MinCell[1] + 1 ) * ( MaxCell[2] - MinCell[2] + 1 );
+    if( NumCells > m_OccupiedLeaves.size() )
+    {
+        for( const SOctreeNode* pNode : m_OccupiedLeaves )
+        {
+            if( pNode->Box.Intersect( LeafBox ) )
+                AddObjects( *pNode );
+        }
+
+        return;
+    }
 
-            if( pNode->Box.Intersect( pOtherNode->Box ) )
+    for( tgUInt32 x = MinCell[0]; x <= MaxCell[0]; ++x )
+    {
+        for( tgUInt32 y = MinCell[1]; y <= MaxCell[1]; ++y )
+        {
+            for( tgUInt32 z = MinCell[2]; z <= MaxCell[2]; ++z )
             {
-                pNode->NeighbourNodes.push_back( pOtherNode );
-                pOtherNode->NeighbourNodes.push_back( pNode );
+                const SOctreeNode* pNode = GetLeaf( x, y, z );
+                if( pNode )
+                    AddObjects( *pNode );
             }
         }
     }
 }
 
-void COctree::UpdateObjectNeighbourNodes( IOctreeObject* pObject, const SOctreeNode* pCurrentNode )
+tgUInt64 COctree::GetLocationCode( const tgUInt32 CellX, const tgUInt32 CellY, const tgUInt32 CellZ, const tgUInt32 DepthIndex )
+{
+    // Offset indices put x in the high bit and z in the low bit
+    return ( static_cast<tgUInt64>( 1 ) << ( DepthIndex * 3 ) ) | ( SpreadBits( CellX ) << 2 ) | ( SpreadBits( CellY ) << 1 ) | SpreadBits( CellZ );
+}
+
+void COctree::GetCell( const tgUInt64 LocationCode, const tgUInt32 DepthIndex, tgUInt32& rCellX, tgUInt32& rCellY, tgUInt32& rCellZ )
+{
+    const tgUInt64 Cell = LocationCode & ~( static_cast<tgUInt64>( 1 ) << ( DepthIndex * 3 ) );
+
+    rCellX = CompactBits( Cell >> 2 );
+    rCellY = CompactBits( Cell >> 1 );
+    rCellZ = CompactBits( Cell );
+}
+
+void COctree::UpdateOccupiedLeaf( SOctreeNode* pNode )
 {
 #if !defined( FINAL )
     tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 
-    const tgFloat              BoxExtent = pObject->GetBoundingSphere()->GetRadius();
-    const tgCAABox3D           ObjectBox( *pObject->GetPosition() - BoxExtent, *pObject->GetPosition() + BoxExtent );
-    std::vector<SOctreeNode*>& rObjectNeighbourNodes = pObject->GetCurrentNeighbourNodes();
-    rObjectNeighbourNodes.clear();
+    const tgBool IsOccupied = pNode->OccupiedIndex != SOctreeNode::INVALID_INDEX;
+    if( IsOccupied != pNode->Objects.empty() )
+        return;
 
-    for( SOctreeNode* pNeighbourNode : pCurrentNode->NeighbourNodes )
+    if( IsOccupied )
     {
-        if( pNeighbourNode->Box.Intersect( ObjectBox ) )
-            rObjectNeighbourNodes.push_back( pNeighbourNode );
+        // Swap the last occupied leaf into the emptied slot
+        SOctreeNode* pLastNode = m_OccupiedLeaves.back();
+
+        m_OccupiedLeaves[pNode->OccupiedIndex] = pLastNode;
+        pLastNode->OccupiedIndex               = pNode->OccupiedIndex;
+        pNode->OccupiedIndex                   = SOctreeNode::INVALID_INDEX;
+
+        m_OccupiedLeaves.pop_back();
     }
+    else
+    {
+        pNode->OccupiedIndex = static_cast<tgUInt32>( m_OccupiedLeaves.size() );
+        m_OccupiedLeaves.push_back( pNode );
+    }
+}
+
+void COctree::AddObject( SOctreeNode* pNode, IOctreeObject* pObject )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    pObject->SetCurrentNode( pNode );
+    pObject->SetCurrentNodeSlot( static_cast<tgUInt32>( pNode->Objects.size() ) );
+    pNode->Objects.push_back( pObject );
+
+    if( pObject->GetBoundingSphere() )
+        m_MaxObjectRadius = std::max( m_MaxObjectRadius, pObject->GetBoundingSphere()->GetRadius() );
+
+    UpdateOccupiedLeaf( pNode );
+}
+
+void COctree::RemoveObject( IOctreeObject* pObject )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    SOctreeNode*   pNode = pObject->GetCurrentNode();
+    const tgUInt32 Slot  = pObject->GetCurrentNodeSlot();
+
+    // Move the last object of the leaf into the freed slot
+    IOctreeObject* pLastObject = pNode->Objects.back();
+    pNode->Objects[Slot]       = pLastObject;
+    pLastObject->SetCurrentNodeSlot( Slot );
+    pNode->Objects.pop_back();
+
+    pObject->SetCurrentNode( nullptr );
+    pObject->SetCurrentNodeSlot( IOctreeObject::INVALID_SLOT );
+
+    UpdateOccupiedLeaf( pNode );
+}
+
+void COctree::MoveObject( IOctreeObject* pObject, const tgUInt32 LeafIndex )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    if( GetObjectLeaf( pObject ) == LeafIndex )
+        return;
+
+    if( pObject->GetCurrentNode() )
+        RemoveObject( pObject );
+
+    if( LeafIndex != INVALID_LEAF )
+        AddObject( &m_Leaves[LeafIndex], pObject );
+}
+
+tgUInt32 COctree::GetObjectLeaf( IOctreeObject* pObject ) const
+{
+    const SOctreeNode* pCurrentNode = pObject->GetCurrentNode();
+
+    return pCurrentNode ? static_cast<tgUInt32>( pCurrentNode - m_Leaves.data() ) : INVALID_LEAF;
+}
+
+tgUInt32 COctree::FindObjectLeaf( IOctreeObject* pObject ) const
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    // Objects keep their leaf until they are outside its box, so an object on a shared face does not flip between leaves
+    const SOctreeNode* pCurrentNode = pObject->GetCurrentNode();
+    if( pCurrentNode && pCurrentNode->Box.PointInside( *pObject->GetPosition() ) )
+        return GetObjectLeaf( pObject );
+
+    return GetLeafIndex( *pObject->GetPosition() );
+}
+
+void COctree::FindObjectLeaves( const std::vector<IOctreeObject*>& rObjects, const tgSize First, const tgSize Last )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    // Only reads the leaves and writes to the batch's own slots, so batches can run at the same time
+    for( tgSize i = First; i < Last; ++i )
+        m_UpdateLeafIndices[i] = FindObjectLeaf( rObjects[i] );
+}
+
+void COctree::FindObjectLeaves( SUpdateParams* pParams )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    std::unique_lock<std::mutex> Lock( pParams->Mutex );
+    while( pParams->NextObject < pParams->NumObjects )
+    {
+        const tgUInt32 First = pParams->NextObject;
+        const tgUInt32 Last  = std::min( First + UPDATE_BATCH_SIZE, pParams->NumObjects );
+        pParams->NextObject  = Last;
+
+        Lock.unlock();
+        FindObjectLeaves( *pParams->pObjects, First, Last );
+        Lock.lock();
+
+        pParams->NumFinishedObjects += Last - First;
+        if( pParams->NumFinishedObjects == pParams->NumObjects )
+            pParams->WorkDone.notify_one();
+    }
+}
+
+void COctree::StartUpdateThreads( void )
+{
+    if( m_pUpdateParams )
+        return;
+
+    m_pUpdateParams                     = new SUpdateParams();
+    m_pUpdateParams->pOctree            = this;
+    m_pUpdateParams->pObjects           = nullptr;
+    m_pUpdateParams->NumObjects         = 0;
+    m_pUpdateParams->NextObject         = 0;
+    m_pUpdateParams->NumFinishedObjects = 0;
+    m_pUpdateParams->IsStopping         = false;
+
+    // The calling thread is one of the workers
+    const tgUInt32 NumThreads = std::thread::hardware_concurrency() - 1;
+    m_UpdateThreads.reserve( NumThreads );
+
+    for( tgUInt32 i = 0; i < NumThreads; ++i )
+        m_UpdateThreads.push_back( new tgCThread( "OctreeUpdate", UpdateObjectsThread, tgCThread::PRIORITY_NORMAL, 65536U, m_pUpdateParams ) );
+}
+
+void COctree::UpdateObjectsThread( tgCThread* pThread )
+{
+#if !defined( FINAL )
+    tgProfilingScope( __TG_FUNC__ );
+#endif // !FINAL
+
+    SUpdateParams* pParams = static_cast<SUpdateParams*>( pThread->GetUserData() );
+
+    while( true )
+    {
+        {
+            std::unique_lock<std::mutex> Lock( pParams->Mutex );
+            pParams->WorkReady.wait( Lock, [pParams]() { return pParams->IsStopping || pParams->NextObject < pParams->NumObjects; } );
+            if( pParams->IsStopping )
+                return;
+        }
+
+        pParams->pOctree->FindObjectLeaves( pParams );
+    }
+}
+
+tgBool COctree::GetRayHitDistance( IOctreeObject* pObject, const tgCV3D& rStart, const tgCV3D& rDirection, const tgFloat Length, tgFloat& rDistance )
+{
+    const tgCSphere* pSphere = pObject->GetBoundingSphere();
+    if( !pSphere )
+        return false;
+
+    const tgCV3D  ToCenter      = pSphere->GetPos() - rStart;
+    const tgFloat RadiusSquared = pSphere->GetRadius() * pSphere->GetRadius();
+
+    // Rays starting inside the sphere hit it right away
+    if( ToCenter.DotProduct() <= RadiusSquared )
+    {
+        rDistance = 0;
+        return true;
+    }
+
+    const tgFloat Projection      = ToCenter.DotProduct( rDirection );
+    const tgFloat DistanceSquared = ToCenter.DotProduct() - Projection * Projection;
+    if( Projection < 0 || DistanceSquared > RadiusSquared )
+        return false;
+
+    rDistance = Projection - tgMathSqrt( RadiusSquared - DistanceSquared );
+
+    return rDistance <= Length;
 }
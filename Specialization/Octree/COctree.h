@@ -1,34 +1,140 @@
 #pragma once
 
 #include "SOctreeNode.h"
+#include "SOctreeRaycastHit.h"
 
+#include <tgMemoryDisable.h>
+#include <unordered_map>
+#include <tgMemoryEnable.h>
+
+class tgCLine3D;
+class tgCMutex;
+class tgCSphere;
+class tgCThread;
+
+// A linear octree, only the leaves are kept in one array sorted by location code and points find their leaf through a hash of the cell
 class COctree
 {
 public:
-    COctree( tgUInt32 DepthLimit );
+    COctree( tgUInt32 DepthLimit, const tgBool ParallelBuild = false );
+    ~COctree( void );
 
     void UpdateObject( IOctreeObject* pObject );
 
+    // Moves every object of the batch to its new leaf, large batches look up the leaves on worker threads and the moves are applied afterwards
+    void UpdateObjects( const std::vector<IOctreeObject*>& rObjects );
+
     void Render( void );
 
-    void Insert( IOctreeObject* pObject, SOctreeNode* pCurrentNode = nullptr );
+    // Moves the object to the leaf containing its position, or out of the octree when no leaf does
+    void Insert( IOctreeObject* pObject );
+
+    // Returns false for objects the ray should pass through
+    typedef tgBool ( *RaycastFilter )( IOctreeObject* pObject, void* pUserData );
+
+    // Walks the leaves along the line front to back and returns the objects whose bounding spheres are hit within MaxDistance, closest first
+    // Objects are tested in the leaves the line crosses, StopAtFirstHit stops the walk as soon as no later leaf can hold a closer hit
+    tgBool Raycast( const tgCLine3D& rLine, const tgFloat MaxDistance, std::vector<SOctreeRaycastHit>& rHits, const tgBool StopAtFirstHit = false, RaycastFilter pFilter = nullptr, void* pUserData = nullptr ) const;
+
+    // Objects whose bounding spheres overlap the sphere or box in no particular order, objects without a bounding sphere need their position inside
+    tgBool QuerySphere( const tgCSphere& rSphere, std::vector<IOctreeObject*>& rObjects ) const;
+    tgBool QueryAABB( const tgCAABox3D& rBox, std::vector<IOctreeObject*>& rObjects ) const;
+
+    // The K objects with positions closest to the point and within MaxDistance, closest first
+    tgBool QueryKNearest( const tgCV3D& rPoint, const tgUInt32 K, std::vector<IOctreeObject*>& rObjects, const tgFloat MaxDistance = TG_FLOAT_MAX ) const;
 
-    std::vector<SOctreeNode*>  GetNodesWithObjects( void );
-    std::vector<SOctreeNode*>& GetDeepestNodes( void ) { return m_DeepestNodes; }
-    const SOctreeNode*         GetNode( const tgCV3D& rPoint, SOctreeNode* pCurrentNode = nullptr );
+    // Leaves with objects in no particular order, kept up to date by Insert and UpdateObject
+    const std::vector<SOctreeNode*>& GetOccupiedLeaves( void ) const { return m_OccupiedLeaves; }
+    const std::vector<SOctreeNode>&  GetLeaves( void ) const { return m_Leaves; }
+    const SOctreeNode*               GetNode( const tgCV3D& rPoint ) const;
+
+    // The largest bounding sphere ever added, objects can reach this far out of their leaf
+    tgFloat GetMaxObjectRadius( void ) const { return m_MaxObjectRadius; }
+
+    static constexpr tgUInt32 INVALID_LEAF = 0xFFFFFFFF;
+
+    // Location codes spend three bits on every level below the root
+    static constexpr tgUInt32 MAX_DEPTH_LIMIT = 21;
 
 private:
-    void   FindDeepestNodes( std::vector<SOctreeNode*>& rOutput, SOctreeNode* pCurrentNode = nullptr );
-    void   CreateOctree( SOctreeNode* pCurrentNode = nullptr );
-    tgBool CreateNode( SOctreeNode* pParentNode, const tgUInt32 OffsetIndex );
+    // Subtrees below this depth are handed to the worker threads when building in parallel
+    static constexpr tgUInt32 PARALLEL_BUILD_DEPTH = 2;
+
+    struct SBuildParams
+    {
+        COctree*                              pOctree;
+        std::vector<SOctreeNode>              Nodes;
+        std::vector<std::vector<tgCV3D>>      Points;
+        std::vector<std::vector<SOctreeNode>> Leaves;
+
+        tgCMutex* pMutex;
+        tgUInt32  NextNode;
+        tgUInt32  NumFinishedThreads;
+    };
+
+    // Smaller batches are not worth waking the workers for
+    static constexpr tgUInt32 PARALLEL_UPDATE_MIN_OBJECTS = 2048;
+    static constexpr tgUInt32 UPDATE_BATCH_SIZE           = 256;
+
+    // Shared with the update workers, defined in COctree.cpp so the std threading types stay out of this header
+    struct SUpdateParams;
+
+    static void BuildNodesThread( tgCThread* pThread );
+    static void UpdateObjectsThread( tgCThread* pThread );
+
+    void CreateOctree( SOctreeNode& rCurrentNode, std::vector<tgCV3D>& rPoints, std::vector<SOctreeNode>& rLeaves, SBuildParams* pParams ) const;
+    void CreateOctreeParallel( SOctreeNode& rRootNode, std::vector<tgCV3D>& rPoints );
+    void CreateNode( SOctreeNode& rNode, const SOctreeNode& rParentNode, const tgUInt32 OffsetIndex ) const;
 
     void GetNeighbours( void );
-    void UpdateObjectNeighbourNodes( IOctreeObject* pObject, const SOctreeNode* pCurrentNode );
+
+    tgUInt32 GetLeafIndex( const tgCV3D& rPoint ) const;
+    const SOctreeNode* GetLeaf( const tgUInt32 CellX, const tgUInt32 CellY, const tgUInt32 CellZ ) const;
+    tgBool             GetCellRange( const tgCAABox3D& rBox, tgUInt32* pMinCell, tgUInt32* pMaxCell ) const;
+
+    void QueryLeaves( const tgCAABox3D& rBox, const tgCSphere* pSphere, std::vector<IOctreeObject*>& rObjects ) const;
+
+    static tgBool GetRayHitDistance( IOctreeObject* pObject, const tgCV3D& rStart, const tgCV3D& rDirection, const tgFloat Length, tgFloat& rDistance );
+
+    static tgUInt64 GetLocationCode( const tgUInt32 CellX, const tgUInt32 CellY, const tgUInt32 CellZ, const tgUInt32 DepthIndex );
+    static void     GetCell( const tgUInt64 LocationCode, const tgUInt32 DepthIndex, tgUInt32& rCellX, tgUInt32& rCellY, tgUInt32& rCellZ );
+
+    void UpdateOccupiedLeaf( SOctreeNode* pNode );
+
+    void AddObject( SOctreeNode* pNode, IOctreeObject* pObject );
+    void RemoveObject( IOctreeObject* pObject );
+    void MoveObject( IOctreeObject* pObject, const tgUInt32 LeafIndex );
+
+    tgUInt32 GetObjectLeaf( IOctreeObject* pObject ) const;
+    tgUInt32 FindObjectLeaf( IOctreeObject* pObject ) const;
+    void     FindObjectLeaves( const std::vector<IOctreeObject*>& rObjects, const tgSize First, const tgSize Last );
+    void     FindObjectLeaves( SUpdateParams* pParams );
+    void     StartUpdateThreads( void );
 
     const tgUInt32 m_DepthLimit;
 
-    SOctreeNode               m_RootNode;
     const std::vector<tgCV3D> m_Offsets;
 
-    std::vector<SOctreeNode*> m_DeepestNodes;
+    // Leaves never move after building, so nodes and objects can keep pointers to them
+    std::vector<SOctreeNode>               m_Leaves;
+    std::unordered_map<tgUInt64, tgUInt32> m_LeafIndices;
+    std::vector<SOctreeNode*>              m_OccupiedLeaves;
+
+    // Kept between UpdateObjects calls so a frame's batch does not allocate
+    std::vector<tgUInt32> m_UpdateLeafIndices;
+    std::vector<tgUInt32> m_UpdateMoves;
+    std::vector<tgUInt32> m_UpdateLeafStarts;
+
+    // Started by the first batch large enough to share and kept until the octree is destroyed
+    SUpdateParams*          m_pUpdateParams;
+    std::vector<tgCThread*> m_UpdateThreads;
+
+    // The root cube split into m_NumCells leaf cells along every axis
+    tgCAABox3D m_Box;
+    tgUInt32   m_LeafDepth;
+    tgUInt32   m_NumCells;
+    tgFloat    m_CellsPerUnit;
+
+    // The largest bounding sphere ever added, objects can reach this far out of their leaf
+    tgFloat m_MaxObjectRadius;
 };
@@ -4,21 +4,19 @@
 
 #include <tgCV3D.h>
 
-#include <tgMemoryDisable.h>
-#include <vector>
-#include <tgMemoryEnable.h>
-
 struct SOctreeNode;
 
 class IOctreeObject
 {
 public:
+    static constexpr tgUInt32 INVALID_SLOT = 0xFFFFFFFF;
+
     IOctreeObject( const tgSize Id, const tgCV3D* pPosition, const tgCSphere* pBoundingSphere )
         : m_Id( Id )
         , m_pPosition( pPosition )
         , m_pBoundingSphere( pBoundingSphere )
         , m_pCurrentNode( nullptr )
-        , m_CurrentNeighbourNodes()
+        , m_CurrentNodeSlot( INVALID_SLOT )
     {}
 
     const tgSize& GetId( void ) const { return m_Id; }
@@ -29,7 +27,9 @@ public:
     SOctreeNode* GetCurrentNode( void ) { return m_pCurrentNode; }
     void         SetCurrentNode( SOctreeNode* pCurrentNode ) { m_pCurrentNode = pCurrentNode; }
 
-    std::vector<SOctreeNode*>& GetCurrentNeighbourNodes( void ) { return m_CurrentNeighbourNodes; }
+    // Index of this object in the current node's objects, so leaving the node does not have to search for it
+    tgUInt32 GetCurrentNodeSlot( void ) const { return m_CurrentNodeSlot; }
+    void     SetCurrentNodeSlot( const tgUInt32 Slot ) { m_CurrentNodeSlot = Slot; }
 
 protected:
     const tgSize m_Id;
@@ -37,6 +37,6 @@ protected:
     const tgCV3D*    m_pPosition;
     const tgCSphere* m_pBoundingSphere;
 
-    SOctreeNode*              m_pCurrentNode;
-    std::vector<SOctreeNode*> m_CurrentNeighbourNodes;
+    SOctreeNode* m_pCurrentNode;
+    tgUInt32     m_CurrentNodeSlot;
 };
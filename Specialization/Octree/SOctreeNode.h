@@ -16,26 +16,30 @@ struct SOctreeNode
 
     SOctreeNode( SOctreeNode&& ) = default;
 
+    static constexpr tgUInt32 INVALID_INDEX = 0xFFFFFFFF;
+
     SOctreeNode( void )
         : Box( 0 )
         , Center( 0 )
-        , pParentNode( nullptr )
-        , ChildNodes()
         , NeighbourNodes()
-        , OffsetIndex( -1 )
         , DepthIndex( 0 )
+        , LocationCode( 1 )
         , Objects()
+        , OccupiedIndex( INVALID_INDEX )
     {}
 
     tgCAABox3D Box;
     tgCV3D     Center;
 
-    SOctreeNode*              pParentNode;
-    std::vector<SOctreeNode>  ChildNodes;
     std::vector<SOctreeNode*> NeighbourNodes;
 
-    tgSInt32 OffsetIndex;
     tgUInt32 DepthIndex;
 
+    // The offset indices of the path from the root below a leading 1, so the x, y and z cell coordinates are interleaved bits
+    tgUInt64 LocationCode;
+
     std::vector<IOctreeObject*> Objects;
+
+    // Slot in the octree's list of leaves with objects while Objects is not empty
+    tgUInt32 OccupiedIndex;
 };
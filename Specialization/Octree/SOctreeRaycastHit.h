@@ -0,0 +1,10 @@
+#pragma once
+
+class IOctreeObject;
+
+// An object hit by COctree::Raycast and the distance from the start of the ray to its bounding sphere
+struct SOctreeRaycastHit
+{
+    IOctreeObject* pObject;
+    tgFloat        Distance;
+};
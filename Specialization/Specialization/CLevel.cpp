@@ -40,15 +40,18 @@ CLevel::CLevel( void )
 	tgProfilingScope( __TG_FUNC__ );
 #endif // !FINAL
 	
+	// The navmesh reads the navigation world's file as well, so both have to name the same one
+	const tgChar* pNavigationWorldFileName = "worlds/city_navigation.tfw";
+
 	// Load worlds
 	CWorldManager& rWorldManager = CWorldManager::GetInstance();
 	m_pCollisionWorld            = rWorldManager.LoadWorld( "worlds/city_collision.tfw", "Collision" );
-	m_pNavigationWorld           = rWorldManager.LoadWorld( "worlds/city_navigation.tfw", "Navigation" );
+	m_pNavigationWorld           = rWorldManager.LoadWorld( pNavigationWorldFileName, "Navigation" );
 
 	rWorldManager.SetActiveWorld( m_pCollisionWorld );
 
-	m_pNavMesh = new CNavMesh( "Navigation" );
-	m_pOctree  = new COctree( 6 );
+	m_pNavMesh = new CNavMesh( "Navigation", pNavigationWorldFileName, CNavMesh::MAX_POLYGON_VERTICES, 64.0f, true, true );
+	m_pOctree  = new COctree( 6, true );
 
 	m_pPlayer = new CPlayer;
 
@@ -157,8 +160,8 @@ void CLevel::Render( void )
 
 	if( m_pOctree )
 	{
-		rDebugManager.AddText2D( tgCColor::Yellow, tgCString( "Existing Octree Nodes: %d", m_pOctree->GetDeepestNodes().size() ) );
-		rDebugManager.AddText2D( tgCColor::Yellow, tgCString( "Used Octree Nodes:     %d", m_pOctree->GetNodesWithObjects().size() ) );
+		rDebugManager.AddText2D( tgCColor::Yellow, tgCString( "Existing Octree Nodes: %d", m_pOctree->GetLeaves().size() ) );
+		rDebugManager.AddText2D( tgCColor::Yellow, tgCString( "Used Octree Nodes:     %d", m_pOctree->GetOccupiedLeaves().size() ) );
 		rDebugManager.AddText2D( tgCColor::Yellow, "" );
 	}
 
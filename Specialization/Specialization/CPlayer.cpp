@@ -65,7 +65,9 @@ CPlayer::CPlayer( void )
 , m_Grounded( false )
 , m_KillCount( 0 )
 , m_HasShot( false )
+, m_PiercingShots( true )
 , m_SurvivalTime()
+, m_HitObjects()
 {
 	// Load model
 	m_pModel						= CModelManager::GetInstance().LoadModel( "models/orc", "Player", true );
@@ -167,7 +169,7 @@ CPlayer::Update( const tgFloat DeltaTime )
 			}
 			else if(  m_AttackTime >= AttackLength * 0.8f && !m_HasShot )
 			{
-				Shoot();
+				Shoot( m_PiercingShots );
 				m_HasShot = true;	
 			}
 		}
@@ -507,62 +509,36 @@ void CPlayer::HandleEnemyCollision( void )
 	if( !m_IsControlling )
 		return;
 
-	const std::vector<SOctreeNode*> OctreeNodesWithObjects = CLevel::GetInstance().GetOctree()->GetNodesWithObjects();
-
-	for( const SOctreeNode* pOctreeNode : OctreeNodesWithObjects )
+	// Enemies whose bounding spheres hold the point catch the player
+	m_HitObjects.clear();
+	if( CLevel::GetInstance().GetOctree()->QuerySphere( tgCSphere( m_Position + tgCV3D::PositiveY, 0.0f ), m_HitObjects ) )
 	{
-		if( !pOctreeNode->Box.PointInside( m_Position + tgCV3D::PositiveY ) )
-			continue;
-
-		for( IOctreeObject* pObject : pOctreeNode->Objects )
-		{
-			if( pObject->GetBoundingSphere() && pObject->GetBoundingSphere()->PointInside( m_Position + tgCV3D::PositiveY ) )
-			{
-				CGameStates::GetInstance().GetStateMenu()->SetScore( m_SurvivalTime.GetLifeTime(), m_KillCount );
-				CGameStates::GetInstance().SetStateMenu();
-			}
-		}
-
-		for( const SOctreeNode* pNeighbourNode : pOctreeNode->NeighbourNodes )
-		{
-			for( IOctreeObject* pObject : pNeighbourNode->Objects )
-			{
-				if( pObject->GetBoundingSphere() && pObject->GetBoundingSphere()->PointInside( m_Position + tgCV3D::PositiveY ) )
-				{
-					CGameStates::GetInstance().GetStateMenu()->SetScore( m_SurvivalTime.GetLifeTime(), m_KillCount );
-					CGameStates::GetInstance().SetStateMenu();
-				}
-			}
-		}
-
-		return;
+		CGameStates::GetInstance().GetStateMenu()->SetScore( m_SurvivalTime.GetLifeTime(), m_KillCount );
+		CGameStates::GetInstance().SetStateMenu();
 	}
 }
 
-void CPlayer::Shoot( void )
+// Shots pass through enemies that are already dead
+tgBool CPlayer::IsShootable( IOctreeObject* pObject, void* /*pUserData*/ )
+{
+	return !static_cast<CEnemy*>( pObject )->IsDead();
+}
+
+void CPlayer::Shoot( const tgBool Piercing )
 {
 	const tgCCamera& r3DCamera     = *CApplication::GetInstance().Get3DCamera()->GetCamera();
 	const tgCMatrix& rCameraMatrix = r3DCamera.GetTransform().GetMatrixLocal();
 
-	const tgCLine3D                 ShotLine( rCameraMatrix.Pos, rCameraMatrix.Pos + rCameraMatrix.At * 25.0f );
-	const std::vector<SOctreeNode*> OctreeNodesWithObjects = CLevel::GetInstance().GetOctree()->GetNodesWithObjects();
+	const tgFloat   ShotLength = 25.0f;
+	const tgCLine3D ShotLine( rCameraMatrix.Pos, rCameraMatrix.Pos + rCameraMatrix.At * ShotLength );
 
-	for( const SOctreeNode* pOctreeNode : OctreeNodesWithObjects )
-	{
-		if( !ShotLine.Intersect( pOctreeNode->Box ) )
-			continue;
-
-		for( IOctreeObject* pObject : pOctreeNode->Objects )
-		{
-			if( !ShotLine.Intersect( *pObject->GetBoundingSphere() ) )
-				continue;
+	// Single shots only kill the closest enemy, piercing shots kill everything along the line
+	std::vector<SOctreeRaycastHit> Hits;
+	CLevel::GetInstance().GetOctree()->Raycast( ShotLine, ShotLength, Hits, !Piercing, IsShootable );
 
-			CEnemy* pEnemy = reinterpret_cast<CEnemy*>( pObject );
-			if( !pEnemy )
-				continue;
-
-			pEnemy->SetDead();
-			m_KillCount++;
-		}
+	for( const SOctreeRaycastHit& rHit : Hits )
+	{
+		static_cast<CEnemy*>( rHit.pObject )->SetDead();
+		m_KillCount++;
 	}
 }
@@ -15,6 +15,12 @@
 #include	<tgCTimer.h>
 #include	<tgCV3D.h>
 
+#include	<tgMemoryDisable.h>
+#include	<vector>
+#include	<tgMemoryEnable.h>
+
+class IOctreeObject;
+
 class CPlayer : public tgCInputListener
 {
 public:
@@ -67,7 +73,9 @@ private:
 	tgBool	CheckGrounded	( const tgCWorld& rCollisionWorld );
 
 	void	HandleEnemyCollision( void );
-	void	Shoot				( void );
+	void	Shoot				( const tgBool Piercing );
+
+	static tgBool	IsShootable	( IOctreeObject* pObject, void* pUserData );
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -103,8 +111,12 @@ private:
 
 	tgUInt32			m_KillCount;
 	tgBool				m_HasShot;
+	tgBool				m_PiercingShots;
 	tgCTimer			m_SurvivalTime;
 
+	// Kept between frames so the enemy collision query does not allocate
+	std::vector<IOctreeObject*>	m_HitObjects;
+
 };	// CPlayer
 
 #endif // __CPLAYER_H__
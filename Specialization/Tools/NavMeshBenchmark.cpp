@@ -0,0 +1,510 @@
+#include <tgSystem.h>
+
+#include "Navigation/CNavMesh.h"
+#include "Navigation/Pathfinding/Solvers/CAStarSolver.h"
+
+#include <tgCTimer.h>
+#include <tgCV3D.h>
+
+#include <tgMemoryDisable.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <tgMemoryEnable.h>
+
+// Builds a navmesh from a synthetic city grid or an OBJ file without loading a world and prints the timings as JSON
+// Tools/CMakeLists.txt builds it against tgCore without the engine
+//
+// NavMeshBenchmark [-obj File] [-blocks Count] [-block Cells] [-street Cells] [-rubble Percent]
+//                  [-tile Size] [-vertices MaxPolygonVertices] [-edge-error Distance] [-quantize] [-queries Count] [-seed Seed] [-skip-pairwise]
+
+struct SBenchmarkSettings
+{
+    const tgChar* pObjFileName;
+    tgUInt32      NumBlocks;
+    tgUInt32      BlockCells;
+    tgUInt32      StreetCells;
+    tgUInt32      RubblePercent;
+    tgFloat       TileSize;
+    tgUInt32      MaxPolygonVertices;
+    tgFloat       MaxEdgeError;
+    tgBool        QuantizeVertices;
+    tgUInt32      NumQueries;
+    tgUInt32      Seed;
+    tgBool        SkipPairwise;
+};
+
+struct SAdjacencyResult
+{
+    tgUInt32 NumTriangles;
+    tgDouble PairwiseTime;
+    tgUInt32 NumPairwiseLinks;
+    tgDouble SharedEdgeTime;
+    tgUInt32 NumSharedEdgeLinks;
+};
+
+struct SBenchmarkResult
+{
+    CNavMesh::SBuildTimes BuildTimes;
+    tgDouble              BuildTime;
+    tgUInt32              NumTiles;
+    tgUInt32              NumNodes;
+    tgUInt32              NumEdges;
+    tgUInt32              NumComponents;
+
+    tgDouble GetNodeTime;
+    tgUInt32 NumFoundNodes;
+    tgDouble RaycastTime;
+    tgUInt32 NumRaycastHits;
+    tgDouble PathTime;
+    tgUInt32 NumFoundPaths;
+    tgUInt64 NumExpandedNodes;
+};
+
+// Streets are walkable ground between square blocks, rubble knocks random cells out of the streets so the boundary gets ragged
+void GenerateCity( const SBenchmarkSettings& rSettings, std::vector<tgCV3D>& rVertices, std::vector<tgUInt32>& rIndices )
+{
+    const tgUInt32 Period   = rSettings.BlockCells + rSettings.StreetCells;
+    const tgUInt32 NumCells = rSettings.NumBlocks * Period + rSettings.StreetCells;
+
+    std::mt19937                            Random( rSettings.Seed );
+    std::uniform_int_distribution<tgUInt32> Percent( 0, 99 );
+
+    for( tgUInt32 CellZ = 0; CellZ < NumCells; ++CellZ )
+    {
+        for( tgUInt32 CellX = 0; CellX < NumCells; ++CellX )
+        {
+            const tgBool IsStreet = CellX % Period < rSettings.StreetCells || CellZ % Period < rSettings.StreetCells;
+            if( !IsStreet || Percent( Random ) < rSettings.RubblePercent )
+                continue;
+
+            const tgUInt32 FirstVertex = static_cast<tgUInt32>( rVertices.size() );
+            const tgFloat  X           = static_cast<tgFloat>( CellX );
+            const tgFloat  Z           = static_cast<tgFloat>( CellZ );
+
+            rVertices.push_back( tgCV3D( X, 0, Z ) );
+            rVertices.push_back( tgCV3D( X + 1, 0, Z ) );
+            rVertices.push_back( tgCV3D( X, 0, Z + 1 ) );
+            rVertices.push_back( tgCV3D( X + 1, 0, Z + 1 ) );
+
+            const tgUInt32 Corners[6] = { 0, 3, 1, 0, 2, 3 };
+            for( const tgUInt32 Corner : Corners )
+                rIndices.push_back( FirstVertex + Corner );
+        }
+    }
+}
+
+// Reads the positions and faces of an OBJ file, polygons are split into fans and everything else is skipped
+tgBool LoadObj( const tgChar* pFileName, std::vector<tgCV3D>& rVertices, std::vector<tgUInt32>& rIndices )
+{
+    FILE* pFile = fopen( pFileName, "r" );
+    if( !pFile )
+        return false;
+
+    tgChar Line[1024];
+    while( fgets( Line, sizeof( Line ), pFile ) )
+    {
+        if( Line[0] == 'v' && Line[1] == ' ' )
+        {
+            tgCV3D Position( 0 );
+            if( sscanf( Line + 2, "%f %f %f", &Position.x, &Position.y, &Position.z ) == 3 )
+                rVertices.push_back( Position );
+
+            continue;
+        }
+
+        if( Line[0] != 'f' || Line[1] != ' ' )
+            continue;
+
+        std::vector<tgUInt32> Face;
+        for( tgChar* pToken = strtok( Line + 2, " \t\r\n" ); pToken; pToken = strtok( nullptr, " \t\r\n" ) )
+        {
+            // Negative indices count back from the last vertex, texture and normal indices after the slashes are ignored
+            const tgSInt32 Index = atoi( pToken );
+            if( Index > 0 && static_cast<tgSize>( Index ) <= rVertices.size() )
+                Face.push_back( static_cast<tgUInt32>( Index - 1 ) );
+            else if( Index < 0 && static_cast<tgSize>( -Index ) <= rVertices.size() )
+                Face.push_back( static_cast<tgUInt32>( rVertices.size() + Index ) );
+        }
+
+        for( tgSize i = 2; i < Face.size(); ++i )
+        {
+            rIndices.push_back( Face[0] );
+            rIndices.push_back( Face[i - 1] );
+            rIndices.push_back( Face[i] );
+        }
+    }
+
+    fclose( pFile );
+    return !rIndices.empty();
+}
+
+// The adjacency builder used before the shared-edge hash map, every triangle is compared with every later one until it has three neighbours
+tgUInt32 FindNeighboursPairwise( const std::vector<tgCV3D>& rVertices, const std::vector<tgUInt32>& rIndices )
+{
+    const tgSize                       NumTriangles = rIndices.size() / 3;
+    std::vector<std::vector<tgUInt32>> Neighbours( NumTriangles );
+    tgUInt32                           NumLinks = 0;
+
+    for( tgSize Triangle = 0; Triangle < NumTriangles; ++Triangle )
+    {
+        for( tgSize OtherTriangle = Triangle + 1; OtherTriangle < NumTriangles && Neighbours[Triangle].size() < 3; ++OtherTriangle )
+        {
+            tgUInt32 SharedVertices = 0;
+            for( tgUInt32 VertexIndex = 0; VertexIndex < 3; VertexIndex++ )
+            {
+                const tgCV3D& rVertex = rVertices[rIndices[Triangle * 3 + VertexIndex]];
+
+                for( tgUInt32 OtherVertexIndex = 0; OtherVertexIndex < 3; OtherVertexIndex++ )
+                {
+                    if( rVertex == rVertices[rIndices[OtherTriangle * 3 + OtherVertexIndex]] )
+                    {
+                        SharedVertices++;
+                        break;
+                    }
+                }
+
+                if( SharedVertices == 2 )
+                {
+                    Neighbours[Triangle].push_back( static_cast<tgUInt32>( OtherTriangle ) );
+                    Neighbours[OtherTriangle].push_back( static_cast<tgUInt32>( Triangle ) );
+                    NumLinks++;
+                    break;
+                }
+            }
+        }
+    }
+
+    return NumLinks;
+}
+
+// The pairwise builder against a triangle-only build of the whole input as one tile, the tile's create step times the shared-edge hash map
+// together with welding, grids and components, so the comparison is slanted against the new builder
+SAdjacencyResult RunAdjacencyBenchmark( const SBenchmarkSettings& rSettings, const std::vector<tgCV3D>& rVertices, const std::vector<tgUInt32>& rIndices, const tgFloat Extent )
+{
+    SAdjacencyResult Result{};
+    Result.NumTriangles = static_cast<tgUInt32>( rIndices.size() / 3 );
+
+    if( !rSettings.SkipPairwise )
+    {
+        tgCTimer PairwiseTimer;
+        Result.NumPairwiseLinks = FindNeighboursPairwise( rVertices, rIndices );
+        Result.PairwiseTime     = PairwiseTimer.GetLifeTime();
+    }
+
+    const CNavMesh NavMesh( rVertices, rIndices, 3, Extent + 1, false, rSettings.QuantizeVertices, rSettings.MaxEdgeError );
+    Result.SharedEdgeTime = NavMesh.GetBuildTimes().Create;
+
+    for( tgUInt32 TileIndex = 0; TileIndex < NavMesh.GetNumTiles(); ++TileIndex )
+    {
+        const CNavMeshTile* pTile = NavMesh.GetTile( TileIndex );
+        if( !pTile )
+            continue;
+
+        for( tgUInt32 Node = 0; Node < pTile->GetNumNodes(); ++Node )
+        {
+            for( const tgUInt32 NeighbourNode : pTile->GetNeighbours( Node ).Nodes )
+                Result.NumSharedEdgeLinks += NeighbourNode != CNavMesh::INVALID_NODE ? 1 : 0;
+        }
+    }
+
+    // Every link is stored on both of its nodes
+    Result.NumSharedEdgeLinks /= 2;
+
+    return Result;
+}
+
+SBenchmarkResult RunBenchmark( const SBenchmarkSettings& rSettings, const std::vector<tgCV3D>& rVertices, const std::vector<tgUInt32>& rIndices, const std::vector<tgCV3D>& rQueryPoints, const tgBool ReorderNodes )
+{
+    SBenchmarkResult Result{};
+
+    // Edges are only found on first use in the game, the benchmark finds them all right away so they are part of the build
+    tgCTimer BuildTimer;
+    CNavMesh NavMesh( rVertices, rIndices, rSettings.MaxPolygonVertices, rSettings.TileSize, ReorderNodes, rSettings.QuantizeVertices, rSettings.MaxEdgeError );
+    NavMesh.FindEdges();
+    Result.BuildTime  = BuildTimer.GetLifeTime();
+    Result.BuildTimes = NavMesh.GetBuildTimes();
+
+    for( tgUInt32 TileIndex = 0; TileIndex < NavMesh.GetNumTiles(); ++TileIndex )
+    {
+        const CNavMeshTile* pTile = NavMesh.GetTile( TileIndex );
+        if( !pTile )
+            continue;
+
+        Result.NumTiles += 1;
+        Result.NumNodes += pTile->GetNumNodes();
+        Result.NumEdges += static_cast<tgUInt32>( pTile->GetEdges().size() );
+    }
+
+    Result.NumComponents = NavMesh.GetNumComponents();
+
+    // Every query point is looked up once, consecutive points then make up the rays and path requests
+    std::vector<tgUInt32> QueryNodes( rQueryPoints.size(), CNavMesh::INVALID_NODE );
+
+    tgCTimer GetNodeTimer;
+    for( tgSize i = 0; i < rQueryPoints.size(); ++i )
+        QueryNodes[i] = NavMesh.GetNode( rQueryPoints[i] );
+
+    Result.GetNodeTime = GetNodeTimer.GetLifeTime();
+
+    for( const tgUInt32 Node : QueryNodes )
+        Result.NumFoundNodes += Node != CNavMesh::INVALID_NODE ? 1 : 0;
+
+    tgCTimer RaycastTimer;
+    for( tgSize i = 0; i + 1 < QueryNodes.size(); i += 2 )
+    {
+        if( QueryNodes[i] == CNavMesh::INVALID_NODE )
+            continue;
+
+        tgCV3D   HitPoint( 0 );
+        tgUInt32 LastNode = CNavMesh::INVALID_NODE;
+        Result.NumRaycastHits += NavMesh.Raycast( QueryNodes[i], rQueryPoints[i], rQueryPoints[i + 1], HitPoint, LastNode ) ? 1 : 0;
+    }
+
+    Result.RaycastTime = RaycastTimer.GetLifeTime();
+
+    CAStarSolver Solver( &NavMesh );
+    tgCTimer     PathTimer;
+    for( tgSize i = 0; i + 1 < QueryNodes.size(); i += 2 )
+    {
+        if( QueryNodes[i] != CNavMesh::INVALID_NODE && QueryNodes[i + 1] != CNavMesh::INVALID_NODE && QueryNodes[i] != QueryNodes[i + 1] )
+            Result.NumFoundPaths += Solver.FindPath( QueryNodes[i], QueryNodes[i + 1] ) == CSolver::PATH_FOUND ? 1 : 0;
+    }
+
+    Result.PathTime         = PathTimer.GetLifeTime();
+    Result.NumExpandedNodes = Solver.GetNumExpandedNodes();
+
+    return Result;
+}
+
+// Prints pString as a JSON string literal, file names may hold quotes, backslashes and control characters
+void PrintJsonString( const tgChar* pString )
+{
+    putchar( '"' );
+
+    for( const tgChar* pCharacter = pString; *pCharacter; ++pCharacter )
+    {
+        const tgUInt8 Character = static_cast<tgUInt8>( *pCharacter );
+
+        if( Character == '"' || Character == '\\' )
+            printf( "\\%c", Character );
+        else if( Character < 0x20 )
+            printf( "\\u%04x", Character );
+        else
+            putchar( Character );
+    }
+
+    putchar( '"' );
+}
+
+void PrintAdjacencyResult( const SAdjacencyResult& rResult, const tgBool SkipPairwise )
+{
+    printf( "  \"adjacency\": { \"triangles\": %u, ", rResult.NumTriangles );
+    if( !SkipPairwise )
+        printf( "\"pairwise_ms\": %.3f, \"pairwise_links\": %u, ", rResult.PairwiseTime * 1000, rResult.NumPairwiseLinks );
+
+    printf( "\"shared_edge_create_ms\": %.3f, \"shared_edge_links\": %u", rResult.SharedEdgeTime * 1000, rResult.NumSharedEdgeLinks );
+
+    if( !SkipPairwise && rResult.SharedEdgeTime > 0 )
+        printf( ", \"speedup\": %.1f", rResult.PairwiseTime / rResult.SharedEdgeTime );
+
+    printf( " },\n" );
+}
+
+void PrintResult( const SBenchmarkResult& rResult, const tgBool ReorderNodes, const tgUInt32 NumQueries, const tgBool IsLast )
+{
+    const tgDouble NumQueryPairs = NumQueries / 2 > 0 ? NumQueries / 2 : 1;
+
+    printf( "    {\n" );
+    printf( "      \"reorder_nodes\": %s,\n", ReorderNodes ? "true" : "false" );
+    printf( "      \"tiles\": %u,\n", rResult.NumTiles );
+    printf( "      \"nodes\": %u,\n", rResult.NumNodes );
+    printf( "      \"boundary_edges\": %u,\n", rResult.NumEdges );
+    printf( "      \"components\": %u,\n", rResult.NumComponents );
+    printf( "      \"build_ms\": %.3f,\n", rResult.BuildTime * 1000 );
+    printf( "      \"create_and_adjacency_ms\": %.3f,\n", rResult.BuildTimes.Create * 1000 );
+    printf( "      \"connect_tiles_ms\": %.3f,\n", rResult.BuildTimes.Connect * 1000 );
+    printf( "      \"find_edges_ms\": %.3f,\n", rResult.BuildTimes.FindEdges * 1000 );
+    printf( "      \"find_components_ms\": %.3f,\n", rResult.BuildTimes.FindComponents * 1000 );
+    printf( "      \"get_node_us\": %.3f,\n", rResult.GetNodeTime * 1000000 / ( NumQueries > 0 ? NumQueries : 1 ) );
+    printf( "      \"get_node_found\": %u,\n", rResult.NumFoundNodes );
+    printf( "      \"raycast_us\": %.3f,\n", rResult.RaycastTime * 1000000 / NumQueryPairs );
+    printf( "      \"raycast_hits\": %u,\n", rResult.NumRaycastHits );
+    printf( "      \"path_us\": %.3f,\n", rResult.PathTime * 1000000 / NumQueryPairs );
+    printf( "      \"paths_found\": %u,\n", rResult.NumFoundPaths );
+    printf( "      \"expanded_nodes\": %llu,\n", static_cast<unsigned long long>( rResult.NumExpandedNodes ) );
+    printf( "      \"expanded_nodes_per_second\": %.0f\n", rResult.PathTime > 0 ? rResult.NumExpandedNodes / rResult.PathTime : 0.0 );
+    printf( "    }%s\n", IsLast ? "" : "," );
+}
+
+// Input order time over reordered time, both runs search the same nodes so only the memory layout differs
+void PrintReorderSpeedup( const SBenchmarkResult& rInputOrder, const SBenchmarkResult& rReordered )
+{
+    const auto GetSpeedup = []( const tgDouble InputOrderTime, const tgDouble ReorderedTime ) { return ReorderedTime > 0 ? InputOrderTime / ReorderedTime : 0.0; };
+
+    printf( "  \"reorder_speedup\": { " );
+    printf( "\"get_node\": %.3f, ", GetSpeedup( rInputOrder.GetNodeTime, rReordered.GetNodeTime ) );
+    printf( "\"raycast\": %.3f, ", GetSpeedup( rInputOrder.RaycastTime, rReordered.RaycastTime ) );
+    printf( "\"path\": %.3f, ", GetSpeedup( rInputOrder.PathTime, rReordered.PathTime ) );
+    printf( "\"same_expanded_nodes\": %s }\n", rInputOrder.NumExpandedNodes == rReordered.NumExpandedNodes ? "true" : "false" );
+}
+
+int main( int argc, char** argv )
+{
+    SBenchmarkSettings Settings;
+    Settings.pObjFileName       = nullptr;
+    Settings.NumBlocks          = 16;
+    Settings.BlockCells         = 8;
+    Settings.StreetCells        = 4;
+    Settings.RubblePercent      = 2;
+    Settings.TileSize           = 32.0f;
+    Settings.MaxPolygonVertices = CNavMesh::MAX_POLYGON_VERTICES;
+    Settings.MaxEdgeError       = .05f;
+    Settings.QuantizeVertices   = false;
+    Settings.NumQueries         = 10000;
+    Settings.Seed               = 1;
+    Settings.SkipPairwise       = false;
+
+    for( tgSInt32 i = 1; i < argc; ++i )
+    {
+        const tgChar* pArgument = argv[i];
+        const tgChar* pValue    = i + 1 < argc ? argv[i + 1] : "0";
+
+        if( !strcmp( pArgument, "-quantize" ) )
+        {
+            Settings.QuantizeVertices = true;
+            continue;
+        }
+
+        // The pairwise builder is quadratic and takes long on large inputs
+        if( !strcmp( pArgument, "-skip-pairwise" ) )
+        {
+            Settings.SkipPairwise = true;
+            continue;
+        }
+
+        if( !strcmp( pArgument, "-obj" ) )
+            Settings.pObjFileName = pValue;
+        else if( !strcmp( pArgument, "-blocks" ) )
+            Settings.NumBlocks = static_cast<tgUInt32>( atoi( pValue ) );
+        else if( !strcmp( pArgument, "-block" ) )
+            Settings.BlockCells = static_cast<tgUInt32>( atoi( pValue ) );
+        else if( !strcmp( pArgument, "-street" ) )
+            Settings.StreetCells = static_cast<tgUInt32>( atoi( pValue ) );
+        else if( !strcmp( pArgument, "-rubble" ) )
+            Settings.RubblePercent = static_cast<tgUInt32>( atoi( pValue ) );
+        else if( !strcmp( pArgument, "-tile" ) )
+            Settings.TileSize = static_cast<tgFloat>( atof( pValue ) );
+        else if( !strcmp( pArgument, "-vertices" ) )
+            Settings.MaxPolygonVertices = static_cast<tgUInt32>( atoi( pValue ) );
+        else if( !strcmp( pArgument, "-edge-error" ) )
+            Settings.MaxEdgeError = static_cast<tgFloat>( atof( pValue ) );
+        else if( !strcmp( pArgument, "-queries" ) )
+            Settings.NumQueries = static_cast<tgUInt32>( atoi( pValue ) );
+        else if( !strcmp( pArgument, "-seed" ) )
+            Settings.Seed = static_cast<tgUInt32>( atoi( pValue ) );
+        else
+        {
+            fprintf( stderr, "Unknown argument %s\n", pArgument );
+            return 1;
+        }
+
+        ++i;
+    }
+
+    std::vector<tgCV3D>   Vertices;
+    std::vector<tgUInt32> Indices;
+
+    if( Settings.pObjFileName )
+    {
+        if( !LoadObj( Settings.pObjFileName, Vertices, Indices ) )
+        {
+            fprintf( stderr, "Could not load %s\n", Settings.pObjFileName );
+            return 1;
+        }
+    }
+    else
+    {
+        GenerateCity( Settings, Vertices, Indices );
+    }
+
+    if( Indices.empty() )
+    {
+        fprintf( stderr, "The input has no triangles\n" );
+        return 1;
+    }
+
+    tgCV3D Min = Vertices[Indices[0]];
+    tgCV3D Max = Min;
+    for( const tgUInt32 Index : Indices )
+    {
+        Min.x = std::min( Min.x, Vertices[Index].x );
+        Min.y = std::min( Min.y, Vertices[Index].y );
+        Min.z = std::min( Min.z, Vertices[Index].z );
+        Max.x = std::max( Max.x, Vertices[Index].x );
+        Max.y = std::max( Max.y, Vertices[Index].y );
+        Max.z = std::max( Max.z, Vertices[Index].z );
+    }
+
+    // The same points are queried with and without node reordering, so the runs only differ in memory layout
+    std::mt19937                            Random( Settings.Seed );
+    std::uniform_real_distribution<float>   RandomX( Min.x, Max.x );
+    std::uniform_real_distribution<float>   RandomZ( Min.z, Max.z );
+    std::uniform_real_distribution<float>   RandomWeight( 0, 1 );
+    std::uniform_int_distribution<tgUInt32> RandomTriangle( 0, static_cast<tgUInt32>( Indices.size() / 3 - 1 ) );
+    std::vector<tgCV3D>                     QueryPoints( Settings.NumQueries );
+
+    // GetNode probes from one unit above a point to ten units below it, so points just above the highest vertex reach every polygon of a flat
+    // enough input, taller inputs are probed from random points on their triangles instead
+    const tgFloat ProbeHeight  = .5f;
+    const tgBool  IsFlatEnough = Max.y - Min.y < 10.0f - ProbeHeight;
+
+    for( tgCV3D& rPoint : QueryPoints )
+    {
+        if( IsFlatEnough )
+        {
+            rPoint = tgCV3D( RandomX( Random ), Max.y + ProbeHeight, RandomZ( Random ) );
+            continue;
+        }
+
+        const tgUInt32 Triangle = RandomTriangle( Random );
+        tgFloat        Weight1  = RandomWeight( Random );
+        tgFloat        Weight2  = RandomWeight( Random );
+
+        if( Weight1 + Weight2 > 1 )
+        {
+            Weight1 = 1 - Weight1;
+            Weight2 = 1 - Weight2;
+        }
+
+        const tgCV3D& rPosition0 = Vertices[Indices[Triangle * 3]];
+        const tgCV3D& rPosition1 = Vertices[Indices[Triangle * 3 + 1]];
+        const tgCV3D& rPosition2 = Vertices[Indices[Triangle * 3 + 2]];
+
+        rPoint    = rPosition0 + ( rPosition1 - rPosition0 ) * Weight1 + ( rPosition2 - rPosition0 ) * Weight2;
+        rPoint.y += ProbeHeight;
+    }
+
+    printf( "{\n" );
+    printf( "  \"input\": { \"source\": " );
+    PrintJsonString( Settings.pObjFileName ? Settings.pObjFileName : "city" );
+    printf( ", \"vertices\": %zu, \"triangles\": %zu },\n", Vertices.size(), Indices.size() / 3 );
+    printf( "  \"settings\": { \"tile_size\": %.3f, \"max_polygon_vertices\": %u, \"max_edge_error\": %.3f, \"quantize_vertices\": %s, \"queries\": %u },\n", Settings.TileSize, Settings.MaxPolygonVertices, Settings.MaxEdgeError, Settings.QuantizeVertices ? "true" : "false", Settings.NumQueries );
+    PrintAdjacencyResult( RunAdjacencyBenchmark( Settings, Vertices, Indices, std::max( Max.x - Min.x, Max.z - Min.z ) ), Settings.SkipPairwise );
+    printf( "  \"runs\": [\n" );
+
+    const SBenchmarkResult InputOrder = RunBenchmark( Settings, Vertices, Indices, QueryPoints, false );
+    const SBenchmarkResult Reordered  = RunBenchmark( Settings, Vertices, Indices, QueryPoints, true );
+
+    PrintResult( InputOrder, false, Settings.NumQueries, false );
+    PrintResult( Reordered, true, Settings.NumQueries, true );
+
+    printf( "  ],\n" );
+    PrintReorderSpeedup( InputOrder, Reordered );
+    printf( "}\n" );
+
+    return 0;
+}